@@ -0,0 +1,36 @@
+/**
+ * @file bench.h
+ * @brief 主机基准的计时工具：取多轮中最快的一轮，减少调度抖动的影响
+ */
+
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define BENCH_ROUNDS    7
+
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// 防止编译器把被测调用当作无用代码删除
+static volatile uint32_t bench_sink;
+
+#define BENCH_BEST_NS(best, iters, body) do {                   \
+        (best) = UINT64_MAX;                                    \
+        for (int _r = 0; _r < BENCH_ROUNDS; _r++) {             \
+            uint64_t _t0 = bench_now_ns();                      \
+            for (long _i = 0; _i < (iters); _i++) {             \
+                body;                                           \
+            }                                                   \
+            uint64_t _dt = bench_now_ns() - _t0;                \
+            if (_dt < (best)) (best) = _dt;                     \
+        }                                                       \
+    } while (0)
+
+#endif // HOST_BENCH_H
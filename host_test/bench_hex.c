@@ -0,0 +1,48 @@
+/**
+ * @file bench_hex.c
+ * @brief 十六进制解码基准：原流程（isxdigit 校验 + 逐字符解码）与查表单遍解码
+ *
+ * 输入为典型的十六进制菜名（UTF-8中文，8~16个汉字），以及接近文本区上限的长字符串。
+ */
+
+#include "hex_utils.h"
+#include "bench.h"
+#include "legacy/legacy.h"
+#include <stdio.h>
+#include <string.h>
+
+static void run(const char *label, size_t hex_len, long iters)
+{
+    static char hex[8192 + 1];
+    static uint8_t out[4096 + 1];
+    static const char digits[] = "0123456789ABCDEF";
+
+    for (size_t i = 0; i < hex_len; i++) {
+        hex[i] = digits[(i * 7 + 3) % 16];
+    }
+    hex[hex_len] = '\0';
+
+    uint64_t legacy_ns, table_ns;
+    BENCH_BEST_NS(legacy_ns, iters, {
+        if (legacy_hex_is_valid(hex)) {
+            bench_sink += legacy_hex_to_ascii(hex, (char *)out, sizeof(out));
+        }
+    });
+    BENCH_BEST_NS(table_ns, iters, {
+        bench_sink += hex_decode(hex, hex_len, out, sizeof(out) - 1);
+    });
+
+    double legacy_per = (double)legacy_ns / iters;
+    double table_per = (double)table_ns / iters;
+    printf("%-22s %5zu chars  legacy %9.1f ns  table %9.1f ns  speedup %.2fx\n",
+           label, hex_len, legacy_per, table_per, legacy_per / table_per);
+}
+
+int main(void)
+{
+    run("dish name (8 glyphs)", 48, 2000000);
+    run("dish name (16 glyphs)", 96, 1000000);
+    run("content 1 KB", 2048, 50000);
+    run("text area", 8190, 10000);
+    return 0;
+}
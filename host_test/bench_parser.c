@@ -0,0 +1,284 @@
+/**
+ * @file bench_parser.c
+ * @brief 订单消息解析基准：单遍解析器与原 cJSON 流程
+ *
+ * 语料覆盖POS实际发送的消息形态：压缩键名与旧键名、十六进制菜品名、出餐完成、
+ * 订单编辑、删除与系统消息。原流程按被替换前 bleprph_chr_access() 的做法：
+ * cJSON_Parse 建树，按 t/type、o/orderId、i/c/items 逐一回退查找，
+ * build_dishes_string() 以 malloc/realloc 拼接菜品串，最后 cJSON_Delete。
+ *
+ * 配置时提供 cJSON 源码（-DCJSON_DIR=... 或设置 IDF_PATH）才编译原流程；
+ * 否则只测单遍解析器。堆分配通过链接器 --wrap 统计，两条路径使用同一套计数。
+ */
+
+#include "order_parser.h"
+#include "order_record.h"
+#include "bench.h"
+#include "legacy/legacy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+/* ---------- 堆分配计数 ---------- */
+
+static size_t s_alloc_calls;
+static size_t s_alloc_bytes;
+
+#ifdef BENCH_COUNT_ALLOC
+void *__real_malloc(size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_calloc(size_t n, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    s_alloc_calls++;
+    s_alloc_bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    s_alloc_calls++;
+    s_alloc_bytes += size;
+    return __real_realloc(ptr, size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    s_alloc_calls++;
+    s_alloc_bytes += n * size;
+    return __real_calloc(n, size);
+}
+#endif
+
+/* ---------- 语料 ---------- */
+
+typedef struct {
+    const char *label;
+    const char *json;
+} frame_t;
+
+// 宫保鸡丁 / 鱼香肉丝 / 米饭 / 少辣 的十六进制UTF-8
+#define HEX_GBJD "E5AEABE4BF9DE9B8A1E4B881"
+#define HEX_YXRS "E9B1BCE9A699E88289E4B89D"
+#define HEX_MF   "E7B1B3E9A5AD"
+#define HEX_SL   "E5B091E8BEA3"
+
+static const frame_t s_corpus[] = {
+    { "add (compact)",
+      "{\"t\":\"a\",\"o\":\"POS1-20240611-0042\",\"i\":[\"" HEX_GBJD "\",\"" HEX_YXRS "\",\"" HEX_MF "\"]}" },
+    { "add (legacy keys)",
+      "{\"type\":\"add\",\"orderId\":\"POS1-20240611-0043\",\"items\":[{\"name\":\"" HEX_GBJD "\"},"
+      "{\"name\":\"" HEX_YXRS "\"},{\"name\":\"" HEX_MF "\"}]}" },
+    { "add (qty+mods)",
+      "{\"t\":\"a\",\"o\":\"POS1-20240611-0044\",\"pr\":1,\"i\":[{\"n\":\"" HEX_GBJD "\",\"q\":2,\"m\":\"" HEX_SL "\"},"
+      "{\"n\":\"" HEX_YXRS "\",\"q\":1},{\"n\":\"" HEX_MF "\",\"q\":3}]}" },
+    { "add (12 dishes)",
+      "{\"t\":\"a\",\"o\":\"POS1-20240611-0045\",\"i\":[\"" HEX_GBJD "\",\"" HEX_YXRS "\",\"" HEX_MF "\",\""
+      HEX_GBJD "\",\"" HEX_YXRS "\",\"" HEX_MF "\",\"" HEX_GBJD "\",\"" HEX_YXRS "\",\"" HEX_MF "\",\""
+      HEX_GBJD "\",\"" HEX_YXRS "\",\"" HEX_MF "\"]}" },
+    { "update (done)",
+      "{\"t\":\"u\",\"o\":\"POS1-20240611-0042\",\"status\":true}" },
+    { "update (edit)",
+      "{\"t\":\"u\",\"o\":\"POS1-20240611-0043\",\"status\":false,\"i\":[\"" HEX_GBJD "\",\"" HEX_MF "\"]}" },
+    { "remove",
+      "{\"t\":\"r\",\"o\":\"POS1-20240611-0044\"}" },
+    { "info",
+      "{\"t\":\"i\",\"c\":\"msg\",\"content\":\"" HEX_GBJD HEX_YXRS "\",\"timestamp\":1718090000000}" },
+};
+
+#define CORPUS_SIZE (sizeof(s_corpus) / sizeof(s_corpus[0]))
+
+/* ---------- 原流程 ---------- */
+
+#ifdef HAVE_CJSON
+// 与原 decode_hex_content() 相同：整串校验后逐字符解码
+static const char *legacy_decode_hex(const char *hex, char *buf, size_t size)
+{
+    if (strlen(hex) % 2 != 0 || !legacy_hex_is_valid(hex)) return NULL;
+    return legacy_hex_to_ascii(hex, buf, size) > 0 ? buf : NULL;
+}
+
+static char *legacy_build_dishes_string(cJSON *items)
+{
+    size_t capacity = 512;
+    char *dishes = malloc(capacity);
+    if (!dishes) return NULL;
+    dishes[0] = '\0';
+    size_t dishes_len = 0;
+    int count = 0;
+
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, items) {
+        if (count >= 20) break;
+        const char *name;
+        char decoded[128] = {0};
+        if (cJSON_IsObject(item)) {
+            cJSON *n = cJSON_GetObjectItem(item, "name");
+            if (!cJSON_IsString(n) || !n->valuestring) continue;
+            name = n->valuestring;
+        } else if (cJSON_IsString(item)) {
+            name = item->valuestring;
+        } else {
+            continue;
+        }
+        const char *display = legacy_decode_hex(name, decoded, sizeof(decoded));
+        if (!display) display = name;
+
+        size_t name_len = strlen(display);
+        size_t needed = dishes_len + (count > 0 ? 3 : 0) + name_len + 1;
+        if (needed > capacity) {
+            capacity = needed * 2;
+            char *grown = realloc(dishes, capacity);
+            if (!grown) {
+                free(dishes);
+                return NULL;
+            }
+            dishes = grown;
+        }
+        if (count > 0) {
+            strncat(dishes, "、", capacity - dishes_len - 1);
+            dishes_len += 3;
+        }
+        strncat(dishes, display, capacity - dishes_len - 1);
+        dishes_len += name_len;
+        count++;
+    }
+    if (count == 0) {
+        free(dishes);
+        return NULL;
+    }
+    return dishes;
+}
+
+static uint32_t legacy_handle(const char *json)
+{
+    uint32_t result = 0;
+    cJSON *root = cJSON_Parse(json);
+    if (!root) return 0;
+
+    cJSON *type = cJSON_GetObjectItem(root, "t");
+    if (!type) type = cJSON_GetObjectItem(root, "type");
+    if (cJSON_IsString(type)) {
+        const char *t = type->valuestring;
+        if (strcmp(t, "info") == 0 || strcmp(t, "i") == 0) {
+            cJSON *content = cJSON_GetObjectItem(root, "content");
+            char decoded[256] = {0};
+            if (cJSON_IsString(content) && legacy_decode_hex(content->valuestring, decoded, sizeof(decoded))) {
+                result += decoded[0];
+            }
+        } else {
+            cJSON *id = cJSON_GetObjectItem(root, "o");
+            if (!id) id = cJSON_GetObjectItem(root, "orderId");
+            if (cJSON_IsString(id)) {
+                result += id->valuestring[0];
+                cJSON *items = cJSON_GetObjectItem(root, "i");
+                if (!items) items = cJSON_GetObjectItem(root, "c");
+                if (!items) items = cJSON_GetObjectItem(root, "items");
+                if (cJSON_IsArray(items)) {
+                    char *dishes = legacy_build_dishes_string(items);
+                    if (dishes) {
+                        result += strlen(dishes);
+                        free(dishes);
+                    }
+                }
+                cJSON *status = cJSON_GetObjectItem(root, "status");
+                if (cJSON_IsBool(status)) {
+                    result += status->valueint;
+                }
+            }
+        }
+    }
+    cJSON_Delete(root);
+    return result;
+}
+#endif
+
+/* ---------- 基准 ---------- */
+
+static order_record_t s_rec;
+
+static uint32_t parser_handle(const char *json, size_t len)
+{
+    if (order_parser_parse(json, len, &s_rec) != ESP_OK) return 0;
+    return s_rec.item_count + s_rec.text_len;
+}
+
+static void report(const char *path, uint64_t best_ns, long iters, size_t calls, size_t bytes)
+{
+    double per_ns = (double)best_ns / iters;
+    printf("  %-8s %8.0f ns  %9.0f msg/s  %4zu allocs  %6zu B/msg\n",
+           path, per_ns, 1e9 / per_ns, calls, bytes);
+}
+
+// 单独跑一次以统计分配，计时循环不计数
+static void count_allocs(uint32_t (*fn)(const char *, size_t), const char *json, size_t len,
+                         size_t *calls, size_t *bytes)
+{
+    s_alloc_calls = 0;
+    s_alloc_bytes = 0;
+    bench_sink += fn(json, len);
+    *calls = s_alloc_calls;
+    *bytes = s_alloc_bytes;
+}
+
+#ifdef HAVE_CJSON
+static uint32_t legacy_handle_len(const char *json, size_t len)
+{
+    (void)len;
+    return legacy_handle(json);
+}
+#endif
+
+int main(void)
+{
+    const long iters = 200000;
+    uint64_t total_parser = 0;
+#ifdef HAVE_CJSON
+    uint64_t total_legacy = 0;
+#endif
+
+#ifndef BENCH_COUNT_ALLOC
+    printf("(allocation counting unavailable on this toolchain)\n");
+#endif
+#ifndef HAVE_CJSON
+    printf("(cJSON not found: configure with -DCJSON_DIR=<dir with cJSON.c> or IDF_PATH to compare)\n");
+#endif
+
+    for (size_t f = 0; f < CORPUS_SIZE; f++) {
+        const char *json = s_corpus[f].json;
+        size_t len = strlen(json);
+        uint64_t ns;
+        size_t calls, bytes;
+
+        if (order_parser_parse(json, len, &s_rec) != ESP_OK) {
+            printf("  %-18s rejected by parser, corpus error\n", s_corpus[f].label);
+            return 1;
+        }
+
+        printf("%s (%zu bytes)\n", s_corpus[f].label, len);
+        count_allocs(parser_handle, json, len, &calls, &bytes);
+        BENCH_BEST_NS(ns, iters, { bench_sink += parser_handle(json, len); });
+        report("parser", ns, iters, calls, bytes);
+        total_parser += ns;
+
+#ifdef HAVE_CJSON
+        count_allocs(legacy_handle_len, json, len, &calls, &bytes);
+        BENCH_BEST_NS(ns, iters, { bench_sink += legacy_handle(json); });
+        report("cJSON", ns, iters, calls, bytes);
+        total_legacy += ns;
+#endif
+    }
+
+    printf("corpus mix: parser %.0f msg/s", 1e9 * CORPUS_SIZE / ((double)total_parser / iters));
+#ifdef HAVE_CJSON
+    printf(", cJSON %.0f msg/s, speedup %.2fx", 1e9 * CORPUS_SIZE / ((double)total_legacy / iters),
+           (double)total_legacy / total_parser);
+#endif
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file bench_utf8.c
+ * @brief UTF-8验证基准：原逐字节实现与 DFA + 8字节ASCII跳过
+ *
+ * 输入为入站帧的典型形态：纯ASCII的紧凑JSON（菜名为十六进制）、含中文菜名的JSON，
+ * 以及接近一帧上限的长文本。
+ */
+
+#include "utf8_validator.h"
+#include "bench.h"
+#include "legacy/legacy.h"
+#include <stdio.h>
+#include <string.h>
+
+// 整段重复 unit，余下不足一个 unit 的部分用空格补齐，不截断多字节字符
+static void fill(uint8_t *buf, size_t len, const char *unit)
+{
+    size_t ulen = strlen(unit);
+    size_t whole = len - len % ulen;
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = i < whole ? (uint8_t)unit[i % ulen] : ' ';
+    }
+}
+
+static void run(const char *label, const char *unit, size_t len, long iters)
+{
+    static uint8_t buf[4096];
+    fill(buf, len, unit);
+    if (!legacy_utf8_is_valid(buf, len) || !utf8_is_valid(buf, len)) {
+        printf("%-22s input rejected, skipped\n", label);
+        return;
+    }
+
+    uint64_t legacy_ns, dfa_ns, count_ns;
+    size_t cps = 0;
+    BENCH_BEST_NS(legacy_ns, iters, { bench_sink += legacy_utf8_is_valid(buf, len); });
+    BENCH_BEST_NS(dfa_ns, iters, { bench_sink += utf8_is_valid(buf, len); });
+    BENCH_BEST_NS(count_ns, iters, { bench_sink += utf8_validate_count(buf, len, &cps); });
+
+    double legacy_per = (double)legacy_ns / iters;
+    double dfa_per = (double)dfa_ns / iters;
+    printf("%-22s %5zu bytes  legacy %8.1f ns  dfa %8.1f ns (%.2fx)  dfa+count %8.1f ns\n",
+           label, len, legacy_per, dfa_per, legacy_per / dfa_per, (double)count_ns / iters);
+}
+
+int main(void)
+{
+    static const char ascii_frame[] =
+        "{\"o\":\"A1024\",\"t\":\"add\",\"s\":2,\"i\":[{\"n\":\"E5AEABE4BF9DE9B8A1E4B881\",\"q\":1}]}";
+    static const char cjk_frame[] =
+        "{\"o\":\"A1024\",\"t\":\"add\",\"i\":[{\"n\":\"宫保鸡丁\",\"m\":\"少辣 不要葱\",\"q\":2}]}";
+
+    run("ascii frame", ascii_frame, sizeof(ascii_frame) - 1, 2000000);
+    run("cjk frame", cjk_frame, sizeof(cjk_frame) - 1, 2000000);
+    run("ascii 4 KB", ascii_frame, 4096, 100000);
+    run("cjk 4 KB", cjk_frame, 4096, 100000);
+    run("all cjk 4 KB", "宫保鸡丁鱼香肉丝", 4096, 100000);
+    return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file host_support.c
+ * @brief 被测模块依赖的设备端函数在主机上的替身
+ */
+
+#include "order_record.h"
+#include "menu_catalog.h"
+#include "order_heap.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 与设备端相同，只清头部字段，菜品数组与 text 区域不清零（基准中不放大解析耗时）
+void order_record_reset(order_record_t *rec)
+{
+    memset(rec, 0, offsetof(order_record_t, items));
+    rec->text_len = 0;
+}
+
+// 没有目录：与设备上尚未同步菜单时相同，写入占位名称 "#ID"
+esp_err_t menu_catalog_fill_item(order_record_t *rec, uint16_t id, order_item_t *item)
+{
+    char name[8];
+    int len = snprintf(name, sizeof(name), "#%u", id);
+    if (rec->text_len + len + 1 > ORDER_TEXT_MAX) {
+        rec->truncated = true;
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(rec->text + rec->text_len, name, len + 1);
+    item->name_off = rec->text_len;
+    item->name_len = len;
+    item->glyphs = len;
+    item->menu_id = id;
+    item->station = ORDER_STATION_UNSET;
+    rec->text_len += len + 1;
+    return ESP_ERR_NOT_FOUND;
+}
+
+// 订单堆：主机上直接使用C库
+esp_err_t order_heap_init(void)
+{
+    return ESP_OK;
+}
+
+void *order_heap_alloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *order_heap_realloc(void *ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void order_heap_free(void *ptr)
+{
+    free(ptr);
+}
@@ -0,0 +1,19 @@
+/**
+ * @file legacy.h
+ * @brief 被替换前的实现，函数名加 legacy_ 前缀，与现行实现链接在同一个测试程序中比较
+ */
+
+#ifndef HOST_LEGACY_H
+#define HOST_LEGACY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+uint8_t legacy_hex_char_to_value(char c);
+bool legacy_hex_is_valid(const char *str);
+int legacy_hex_to_ascii(const char *hex, char *output, size_t output_size);
+
+bool legacy_utf8_is_valid(const uint8_t *data, size_t length);
+
+#endif // HOST_LEGACY_H
@@ -0,0 +1,45 @@
+/**
+ * @file utf8_validator_legacy.c
+ * @brief 被替换前的逐字节UTF-8验证（不拒绝超长编码与代理区码点），仅用于对比
+ */
+
+#include "legacy/legacy.h"
+
+bool legacy_utf8_is_valid(const uint8_t *data, size_t length) {
+    bool is_valid_utf8 = true;
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+        if (c > 0x7F) { // 非ASCII字符
+            if ((c & 0xE0) == 0xC0) { // 2字节UTF-8
+                if (i + 1 >= length || (data[i+1] & 0xC0) != 0x80) {
+                    is_valid_utf8 = false;
+                    break;
+                }
+                i++;
+            } else if ((c & 0xF0) == 0xE0) { // 3字节UTF-8
+                if (i + 2 >= length ||
+                    (data[i+1] & 0xC0) != 0x80 ||
+                    (data[i+2] & 0xC0) != 0x80) {
+                    is_valid_utf8 = false;
+                    break;
+                }
+                i += 2;
+            } else if ((c & 0xF8) == 0xF0) { // 4字节UTF-8
+                if (i + 3 >= length ||
+                    (data[i+1] & 0xC0) != 0x80 ||
+                    (data[i+2] & 0xC0) != 0x80 ||
+                    (data[i+3] & 0xC0) != 0x80) {
+                    is_valid_utf8 = false;
+                    break;
+                }
+                i += 3;
+            } else {
+                is_valid_utf8 = false;
+                break;
+            }
+        }
+    }
+
+    return is_valid_utf8;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief 主机测试用的 esp_heap_caps.h 替身，按能力分配直接使用C库
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT         (1 << 2)
+#define MALLOC_CAP_SPIRAM       (1 << 10)
+#define MALLOC_CAP_DEFAULT      (1 << 12)
+
+#define heap_caps_malloc(size, caps)        malloc(size)
+#define heap_caps_calloc(n, size, caps)     calloc(n, size)
+#define heap_caps_free(ptr)                 free(ptr)
+
+#endif // HOST_ESP_HEAP_CAPS_H
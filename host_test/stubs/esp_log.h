@@ -0,0 +1,15 @@
+/**
+ * @file esp_log.h
+ * @brief 主机测试用的 esp_log.h 替身，日志直接丢弃
+ */
+
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#define ESP_LOGE(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGW(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGI(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGD(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGV(tag, fmt, ...) ((void)(tag))
+
+#endif // HOST_ESP_LOG_H
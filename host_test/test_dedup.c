@@ -0,0 +1,102 @@
+/**
+ * @file test_dedup.c
+ * @brief 订单消息去重窗口的测试：重传丢弃，改回先前内容的合法更新保留
+ */
+
+#include "order_dedup.h"
+#include "order_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            s_failures++;                                       \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+static order_record_t s_rec;
+
+// 解析后送入去重窗口，返回是否判为重复
+static bool dup(const char *json)
+{
+    if (order_parser_parse(json, strlen(json), &s_rec) != ESP_OK) {
+        s_failures++;
+        printf("FAIL: corpus rejected by parser: %s\n", json);
+        return false;
+    }
+    return order_dedup_check(&s_rec);
+}
+
+#define UPD_X "{\"t\":\"u\",\"o\":\"ORD1\",\"status\":false,\"i\":[{\"n\":\"A\",\"q\":2}]}"
+#define UPD_Y "{\"t\":\"u\",\"o\":\"ORD1\",\"status\":false,\"i\":[{\"n\":\"A\",\"q\":3}]}"
+
+// 无序号：紧接着的重传丢弃，X→Y→X 的第三条照常应用
+static void test_revert_without_seq(void)
+{
+    order_dedup_reset();
+    CHECK(!dup(UPD_X), "first X");
+    CHECK(dup(UPD_X), "retransmitted X");
+    CHECK(!dup(UPD_Y), "Y");
+    CHECK(!dup(UPD_X), "X after Y must be applied");
+    CHECK(dup(UPD_X), "retransmitted X after revert");
+}
+
+// 无序号：其他订单的消息插在中间不影响本订单的比较
+static void test_interleaved_orders_without_seq(void)
+{
+    order_dedup_reset();
+    CHECK(!dup(UPD_X), "X");
+    CHECK(!dup("{\"t\":\"u\",\"o\":\"ORD2\",\"status\":false,\"i\":[\"B\"]}"), "other order");
+    CHECK(dup(UPD_X), "X retransmitted after another order's message");
+    CHECK(!dup("{\"t\":\"u\",\"o\":\"ORD1\",\"status\":true}"), "done");
+    CHECK(dup("{\"t\":\"u\",\"o\":\"ORD1\",\"status\":true}"), "retransmitted done");
+}
+
+// 有序号：窗口内同一序号即为重传，不论中间有多少条消息
+static void test_seq_window(void)
+{
+    order_dedup_reset();
+    CHECK(!dup("{\"t\":\"u\",\"o\":\"ORD1\",\"q\":1,\"status\":false,\"i\":[\"A\"]}"), "seq 1");
+    CHECK(!dup("{\"t\":\"u\",\"o\":\"ORD1\",\"q\":2,\"status\":false,\"i\":[\"B\"]}"), "seq 2");
+    CHECK(dup("{\"t\":\"u\",\"o\":\"ORD1\",\"q\":1,\"status\":false,\"i\":[\"A\"]}"), "seq 1 retransmitted");
+}
+
+// 窗口满后最旧的条目被淘汰，之后同一消息不再判为重复
+static void test_window_eviction(void)
+{
+    char json[96];
+    order_dedup_reset();
+    CHECK(!dup(UPD_X), "X");
+    for (int i = 0; i < ORDER_DEDUP_WINDOW; i++) {
+        snprintf(json, sizeof(json), "{\"t\":\"r\",\"o\":\"FILL%d\"}", i);
+        CHECK(!dup(json), "filler %d", i);
+    }
+    CHECK(!dup(UPD_X), "X after eviction");
+    // 重新记入 X 挤出了最旧的 FILL0；命中不插入新条目，其余仍在窗口内
+    for (int i = 1; i < ORDER_DEDUP_WINDOW; i++) {
+        snprintf(json, sizeof(json), "{\"t\":\"r\",\"o\":\"FILL%d\"}", i);
+        CHECK(dup(json), "filler %d still in window", i);
+    }
+    CHECK(!dup("{\"t\":\"r\",\"o\":\"FILL0\"}"), "evicted filler 0");
+}
+
+int main(void)
+{
+    test_revert_without_seq();
+    test_interleaved_orders_without_seq();
+    test_seq_window();
+    test_window_eviction();
+
+    if (s_failures) {
+        printf("test_dedup: %d failures\n", s_failures);
+        return 1;
+    }
+    printf("test_dedup: OK\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file test_hex.c
+ * @brief 查表十六进制解码与原逐字符解码的等价性测试
+ *
+ * 原流程为 hex_is_valid() 判断后 hex_to_ascii() 解码；hex_decode() 须在相同输入上给出相同结果：
+ * 全部字节值、奇数长度、各位置上的非十六进制字符，以及8字符快速路径的各个余数。
+ */
+
+#include "hex_utils.h"
+#include "legacy/legacy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            s_failures++;                                       \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+// 原流程：校验全部字符后解码，奇数长度或含非十六进制字符时失败
+static int legacy_decode(const char *hex, uint8_t *out, size_t out_size)
+{
+    char buf[512];
+    if (!legacy_hex_is_valid(hex)) {
+        return -1;
+    }
+    int n = legacy_hex_to_ascii(hex, buf, sizeof(buf));
+    if (n < 0 || (size_t)n > out_size) {
+        return -1;
+    }
+    memcpy(out, buf, n);
+    return n;
+}
+
+static void compare(const char *hex)
+{
+    size_t len = strlen(hex);
+    uint8_t expect[256];
+    uint8_t got[256];
+    uint8_t in_place[512];
+
+    int e = legacy_decode(hex, expect, sizeof(expect));
+    int g = hex_decode(hex, len, got, sizeof(got));
+    CHECK(e == g, "hex_decode(\"%s\") = %d, legacy %d", hex, g, e);
+    if (e == g && e > 0) {
+        CHECK(memcmp(expect, got, e) == 0, "hex_decode(\"%s\") bytes differ", hex);
+    }
+
+    // 就地解码只保证成功时的结果
+    memcpy(in_place, hex, len);
+    g = hex_decode((const char *)in_place, len, in_place, sizeof(in_place));
+    CHECK(e == g, "in-place hex_decode(\"%s\") = %d, legacy %d", hex, g, e);
+    if (e == g && e > 0) {
+        CHECK(memcmp(expect, in_place, e) == 0, "in-place hex_decode(\"%s\") bytes differ", hex);
+    }
+
+    CHECK(hex_is_valid_n(hex, len) == legacy_hex_is_valid(hex), "hex_is_valid_n(\"%s\")", hex);
+    CHECK(hex_is_valid(hex) == legacy_hex_is_valid(hex), "hex_is_valid(\"%s\")", hex);
+
+    // hex_to_ascii 保持原行为：非十六进制字符按0处理
+    char a[256], b[256];
+    int ra = hex_to_ascii(hex, a, sizeof(a));
+    int rb = legacy_hex_to_ascii(hex, b, sizeof(b));
+    CHECK(ra == rb, "hex_to_ascii(\"%s\") = %d, legacy %d", hex, ra, rb);
+    if (ra == rb && ra >= 0) {
+        CHECK(memcmp(a, b, ra + 1) == 0, "hex_to_ascii(\"%s\") bytes differ", hex);
+    }
+}
+
+// 每个字节值（含非十六进制字符）单独以及成对出现
+static void test_every_byte_value(void)
+{
+    for (int c = 1; c < 256; c++) {
+        CHECK(hex_char_to_value((char)c) == legacy_hex_char_to_value((char)c), "hex_char_to_value(0x%02x)", c);
+        for (int d = 1; d < 256; d++) {
+            char s[3] = { (char)c, (char)d, '\0' };
+            compare(s);
+        }
+    }
+}
+
+// 长度0~40（覆盖8字符快速路径的各个余数与奇数长度），非法字符出现在每个位置
+static void test_lengths_and_positions(void)
+{
+    static const char digits[] = "0123456789abcdefABCDEF";
+    static const char invalid[] = { 'g', 'G', 'x', ' ', '-', 0x7f, (char)0x80, (char)0xff };
+    char s[64];
+
+    srand(1);
+    for (size_t len = 0; len <= 40; len++) {
+        for (int round = 0; round < 50; round++) {
+            for (size_t i = 0; i < len; i++) {
+                s[i] = digits[rand() % (sizeof(digits) - 1)];
+            }
+            s[len] = '\0';
+            compare(s);
+
+            for (size_t pos = 0; pos < len; pos++) {
+                char saved = s[pos];
+                s[pos] = invalid[rand() % sizeof(invalid)];
+                compare(s);
+                s[pos] = saved;
+            }
+        }
+    }
+}
+
+// 输出空间恰好够用与差一个字节
+static void test_output_size(void)
+{
+    uint8_t out[8];
+    CHECK(hex_decode("00112233", 8, out, 4) == 4, "exact output size");
+    CHECK(hex_decode("00112233", 8, out, 3) == -1, "output one byte short");
+    CHECK(hex_decode("", 0, out, 0) == 0, "empty input");
+}
+
+int main(void)
+{
+    test_every_byte_value();
+    test_lengths_and_positions();
+    test_output_size();
+
+    if (s_failures) {
+        printf("test_hex: %d failures\n", s_failures);
+        return 1;
+    }
+    printf("test_hex: OK\n");
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_parser.c
+ * @brief 订单解析器的边界测试
+ */
+
+#include "order_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD_SIZE  4096
+#define GUARD_BYTE  0xA5
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            s_failures++;                                       \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+// 记录之后紧跟保护区，解析器越界写入时保护区被改写（设备上即记录池中的下一条记录）
+static order_record_t *record_with_guard(void)
+{
+    uint8_t *mem = malloc(sizeof(order_record_t) + GUARD_SIZE);
+    memset(mem + sizeof(order_record_t), GUARD_BYTE, GUARD_SIZE);
+    return (order_record_t *)mem;
+}
+
+static bool guard_intact(const order_record_t *rec)
+{
+    const uint8_t *guard = (const uint8_t *)rec + sizeof(order_record_t);
+    for (size_t i = 0; i < GUARD_SIZE; i++) {
+        if (guard[i] != GUARD_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * 偶数长度的十六进制菜名恰好填满剩余文本区（n == cap）时，解码结果没有放在原文之后的空间，
+ * 必须走校验后就地解码的路径，不得写出 text 之外。
+ */
+static void test_hex_string_fills_remaining_text(size_t hex_len)
+{
+    // 第一个菜品占去 text 前部，使第二个菜品的可用空间 cap = ORDER_TEXT_MAX - text_len - 1 恰为 hex_len
+    size_t filler_len = ORDER_TEXT_MAX - 2 - hex_len;
+    size_t json_size = filler_len + hex_len + 128;
+    char *json = malloc(json_size);
+    size_t len = 0;
+
+    len += snprintf(json + len, json_size - len, "{\"t\":\"a\",\"o\":\"ORD0001\",\"i\":[\"");
+    memset(json + len, 'x', filler_len);
+    len += filler_len;
+    len += snprintf(json + len, json_size - len, "\",\"");
+    for (size_t i = 0; i < hex_len; i += 2) {
+        memcpy(json + len + i, "41", 2);    // 解码为 'A'，是有效的UTF-8
+    }
+    len += hex_len;
+    len += snprintf(json + len, json_size - len, "\"]}");
+
+    order_record_t *rec = record_with_guard();
+    esp_err_t err = order_parser_parse(json, len, rec);
+
+    CHECK(guard_intact(rec), "hex_len=%zu: write past order_record_t.text", hex_len);
+    CHECK(err == ESP_OK, "hex_len=%zu: parse returned %d", hex_len, err);
+    CHECK(rec->item_count == 2, "hex_len=%zu: item_count %d", hex_len, rec->item_count);
+    if (err == ESP_OK && rec->item_count == 2) {
+        const char *name = order_record_item_name(rec, 1);
+        size_t expect = hex_len / 2;
+        bool decoded = rec->items[1].name_len == expect && strlen(name) == expect;
+        for (size_t i = 0; decoded && i < expect; i++) {
+            decoded = name[i] == 'A';
+        }
+        CHECK(decoded, "hex_len=%zu: name not decoded in place (len %u)", hex_len, rec->items[1].name_len);
+        CHECK(!rec->truncated, "hex_len=%zu: unexpectedly truncated", hex_len);
+    }
+
+    free(rec);
+    free(json);
+}
+
+// 剩余空间足够时解码到原文之后再拷回
+static void test_hex_string_with_room(void)
+{
+    static const char json[] = "{\"t\":\"a\",\"o\":\"ORD0002\",\"i\":[\"E5AEABE4BF9DE9B8A1E4B881\"]}";
+    order_record_t *rec = record_with_guard();
+
+    CHECK(order_parser_parse(json, strlen(json), rec) == ESP_OK, "parse");
+    CHECK(rec->item_count == 1 && strcmp(order_record_item_name(rec, 0), "宫保鸡丁") == 0, "hex name decoded");
+    CHECK(rec->item_count == 1 && rec->items[0].glyphs == 4, "glyph count");
+    CHECK(guard_intact(rec), "guard");
+    free(rec);
+}
+
+// 明确的工位0与未指定工位要区分开，未指定的才按分类映射补全
+static void test_station_explicit_zero(void)
+{
+    static const char json[] =
+        "{\"t\":\"a\",\"o\":\"ORD0003\",\"i\":[{\"n\":\"A\",\"st\":0},{\"n\":\"B\"},\"C\","
+        "{\"id\":7},{\"id\":7,\"st\":0},{\"n\":\"D\",\"st\":2}]}";
+    static const uint8_t expect[] = { 0, ORDER_STATION_UNSET, ORDER_STATION_UNSET, ORDER_STATION_UNSET, 0, 2 };
+    order_record_t *rec = record_with_guard();
+
+    CHECK(order_parser_parse(json, strlen(json), rec) == ESP_OK, "parse");
+    CHECK(rec->item_count == sizeof(expect), "item count %u", rec->item_count);
+    for (size_t i = 0; i < rec->item_count && i < sizeof(expect); i++) {
+        CHECK(rec->items[i].station == expect[i], "item %zu: station %u, expected %u",
+              i, rec->items[i].station, expect[i]);
+    }
+    free(rec);
+}
+
+int main(void)
+{
+    test_hex_string_with_room();
+    test_station_explicit_zero();
+    // 恰好填满、以及刚好放得下/放不下解码结果的几个长度
+    static const size_t lengths[] = { 2, 4, 8, 1000, 4000, 5460, 5462, 8188 };
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        test_hex_string_fills_remaining_text(lengths[i]);
+    }
+
+    if (s_failures) {
+        printf("test_parser: %d failures\n", s_failures);
+        return 1;
+    }
+    printf("test_parser: OK\n");
+    return 0;
+}
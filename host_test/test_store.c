@@ -0,0 +1,244 @@
+/**
+ * @file test_store.c
+ * @brief 订单存储的工位队列测试：随机操作后按名次读取的结果与暴力排序的参照一致
+ */
+
+#include "order_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            s_failures++;                                       \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+static uint32_t s_rng = 12345;
+
+static uint32_t rnd(uint32_t n)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (s_rng >> 8) % n;
+}
+
+// 与存储相同的处理顺序：优先级高者在前，有期限且早者在前，其余按到达顺序
+static int ref_cmp(const void *a, const void *b)
+{
+    const order_info_t *x = *(order_info_t *const *)a;
+    const order_info_t *y = *(order_info_t *const *)b;
+    if (x->priority != y->priority) {
+        return x->priority > y->priority ? -1 : 1;
+    }
+    if (x->deadline != y->deadline) {
+        if (!x->deadline || !y->deadline) {
+            return x->deadline ? -1 : 1;
+        }
+        return x->deadline < y->deadline ? -1 : 1;
+    }
+    return (int32_t)(x->arrival - y->arrival) < 0 ? -1 : 1;
+}
+
+typedef struct {
+    order_info_t **orders;
+    int count;
+} ref_t;
+
+static void collect(order_info_t *order, void *arg)
+{
+    ref_t *ref = arg;
+    ref->orders[ref->count++] = order;
+}
+
+// 参照：工位 st 的等待队列 = 该工位有菜品、未出餐、且不是该工位焦点的订单，排序后比较
+static void check_station(int st, order_info_t **all, order_info_t **expect, order_info_t **got)
+{
+    ref_t ref = { all, 0 };
+    order_store_foreach(collect, &ref);
+    int n = 0;
+    for (int i = 0; i < ref.count; i++) {
+        order_info_t *o = all[i];
+        if ((order_store_open_stations(o) & (1u << st)) && order_store_focus(st) != o) {
+            expect[n++] = o;
+        }
+    }
+    qsort(expect, n, sizeof(expect[0]), ref_cmp);
+
+    CHECK(order_store_pending_count(st) == n, "station %d: count %d, expected %d",
+          st, order_store_pending_count(st), n);
+    int got_n = order_store_pending_range(st, 0, got, ORDER_STORE_CAPACITY);
+    CHECK(got_n == n, "station %d: range returned %d, expected %d", st, got_n, n);
+    for (int i = 0; i < n && i < got_n; i++) {
+        if (got[i] != expect[i]) {
+            CHECK(false, "station %d: rank %d is %s, expected %s", st, i, got[i]->order_id, expect[i]->order_id);
+            break;
+        }
+    }
+    // 中间的窗口
+    if (n > 0) {
+        int first = rnd(n);
+        int max = 1 + rnd(12);
+        int w = order_store_pending_range(st, first, got, max);
+        int want = n - first < max ? n - first : max;
+        CHECK(w == want, "station %d: window [%d,+%d) returned %d", st, first, max, w);
+        CHECK(w <= 0 || memcmp(got, &expect[first], w * sizeof(got[0])) == 0,
+              "station %d: window [%d,+%d) differs", st, first, max);
+    }
+}
+
+// 按位图为订单重新生成菜品并重新分配工位
+static void set_stations(order_info_t *order, uint8_t stations)
+{
+    order->item_count = 0;
+    order->text_len = 0;
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        if (stations & (1u << st)) {
+            order_store_append_dish(order, "dish", 4, 1, NULL, 0, st);
+        }
+    }
+    order_store_route(order);
+}
+
+static order_info_t *random_order(order_info_t **all)
+{
+    ref_t ref = { all, 0 };
+    order_store_foreach(collect, &ref);
+    return ref.count ? all[rnd(ref.count)] : NULL;
+}
+
+static void test_random_ops(int ops, int max_orders)
+{
+    order_info_t **all = malloc(ORDER_STORE_CAPACITY * sizeof(*all));
+    order_info_t **expect = malloc(ORDER_STORE_CAPACITY * sizeof(*expect));
+    order_info_t **got = malloc(ORDER_STORE_CAPACITY * sizeof(*got));
+    static int next_id = 0;
+    char id[16];
+
+    order_store_clear();
+    for (int op = 0; op < ops && !s_failures; op++) {
+        order_info_t *order;
+        switch (rnd(8)) {
+        case 0:
+        case 1:
+            if (order_store_count() >= max_orders) break;
+            snprintf(id, sizeof(id), "R%d", next_id++);
+            if (order_store_add(id, next_id, &order) != ESP_OK) break;
+            if (rnd(3) == 0) {
+                order_store_set_priority(order, rnd(3), rnd(2) ? 1000 + rnd(50) : 0);
+            }
+            set_stations(order, 1 + rnd(255));
+            break;
+        case 2:
+            if ((order = random_order(all)) != NULL) {
+                order_store_remove(order);
+            }
+            break;
+        case 3:
+            if ((order = random_order(all)) != NULL) {
+                order_store_set_priority(order, rnd(3), rnd(2) ? 1000 + rnd(50) : 0);
+            }
+            break;
+        case 4:
+            if ((order = random_order(all)) != NULL) {
+                uint8_t open = order_store_open_stations(order);
+                for (int st = 0; st < ORDER_STATION_MAX; st++) {
+                    if ((open & (1u << st)) && order_store_complete_station(order, st)) {
+                        order_store_remove(order);
+                        break;
+                    }
+                }
+            }
+            break;
+        case 5:
+            if ((order = random_order(all)) != NULL) {
+                set_stations(order, 1 + rnd(255));
+            }
+            break;
+        default: {
+            int st = rnd(ORDER_STATION_MAX);
+            order = order_store_focus(st);
+            if (!order) {
+                order_store_start_next(st);
+            } else if (order_store_complete_station(order, st)) {
+                order_store_remove(order);
+            }
+            break;
+        }
+        }
+        if (op % 7 == 0) {
+            check_station(rnd(ORDER_STATION_MAX), all, expect, got);
+        }
+    }
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        check_station(st, all, expect, got);
+    }
+    free(all);
+    free(expect);
+    free(got);
+}
+
+// 单工位排满订单池：覆盖两端用尽后的整体居中、队首插入与队首取出
+static void test_full_station(void)
+{
+    order_info_t **all = malloc(ORDER_STORE_CAPACITY * sizeof(*all));
+    order_info_t **expect = malloc(ORDER_STORE_CAPACITY * sizeof(*expect));
+    order_info_t **got = malloc(ORDER_STORE_CAPACITY * sizeof(*got));
+    char id[16];
+    order_info_t *order;
+
+    order_store_clear();
+    for (int i = 0; i < ORDER_STORE_CAPACITY; i++) {
+        snprintf(id, sizeof(id), "F%d", i);
+        CHECK(order_store_add(id, i, &order) == ESP_OK, "add %d", i);
+        // 每8个插到队首，其余追加到队尾
+        order_store_set_priority(order, i % 8 == 0 ? 1 + rnd(3) : 0, 0);
+        set_stations(order, 1);
+    }
+    CHECK(order_store_add("overflow", 0, &order) == ESP_ERR_NO_MEM, "pool full");
+    check_station(0, all, expect, got);
+
+    // 取出一半作为焦点后完成，再补满
+    for (int i = 0; i < ORDER_STORE_CAPACITY / 2; i++) {
+        order = order_store_start_next(0);
+        CHECK(order != NULL, "start_next %d", i);
+        if (order && order_store_complete_station(order, 0)) {
+            order_store_remove(order);
+        }
+    }
+    check_station(0, all, expect, got);
+    for (int i = 0; i < ORDER_STORE_CAPACITY / 2; i++) {
+        snprintf(id, sizeof(id), "G%d", i);
+        CHECK(order_store_add(id, i, &order) == ESP_OK, "refill %d", i);
+        order_store_set_priority(order, rnd(4), 0);
+        set_stations(order, 1);
+    }
+    check_station(0, all, expect, got);
+    order_store_clear();
+    CHECK(order_store_pending_count(0) == 0, "cleared");
+    free(all);
+    free(expect);
+    free(got);
+}
+
+int main(void)
+{
+    if (order_store_init() != ESP_OK) {
+        printf("test_store: init failed\n");
+        return 1;
+    }
+    test_random_ops(200000, 64);
+    test_random_ops(20000, 1500);
+    test_full_station();
+
+    if (s_failures) {
+        printf("test_store: %d failures\n", s_failures);
+        return 1;
+    }
+    printf("test_store: OK\n");
+    return 0;
+}
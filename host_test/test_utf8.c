@@ -0,0 +1,209 @@
+/**
+ * @file test_utf8.c
+ * @brief DFA UTF-8验证与原逐字节验证、严格参考解码的对比测试
+ *
+ * 新实现比原实现更严格：超长编码、代理区与超出U+10FFFF的码点被拒绝。因此检查三点：
+ * 与按RFC 3629逐码点解码的参考实现结果一致；新实现接受的输入原实现也接受；
+ * ASCII快速路径在各种对齐与错误位置下与逐字节结果一致。另测 utf8_trim_len() 的截断边界。
+ */
+
+#include "utf8_validator.h"
+#include "legacy/legacy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            s_failures++;                                       \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+// 参考实现：逐码点解码并检查取值范围，返回码点数，无效时返回-1
+static long reference_count(const uint8_t *s, size_t len)
+{
+    long count = 0;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t c = s[i];
+        size_t n;
+        uint32_t cp, min;
+        if (c < 0x80)      { n = 1; cp = c;        min = 0; }
+        else if (c < 0xC0) { return -1; }
+        else if (c < 0xE0) { n = 2; cp = c & 0x1F; min = 0x80; }
+        else if (c < 0xF0) { n = 3; cp = c & 0x0F; min = 0x800; }
+        else if (c < 0xF8) { n = 4; cp = c & 0x07; min = 0x10000; }
+        else               { return -1; }
+        if (i + n > len) {
+            return -1;
+        }
+        for (size_t k = 1; k < n; k++) {
+            if ((s[i + k] & 0xC0) != 0x80) {
+                return -1;
+            }
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            return -1;
+        }
+        i += n;
+        count++;
+    }
+    return count;
+}
+
+static void compare(const uint8_t *s, size_t len)
+{
+    long expect = reference_count(s, len);
+    size_t count = (size_t)-1;
+    bool ok = utf8_validate_count(s, len, &count);
+
+    CHECK(ok == (expect >= 0), "len=%zu first=%02X: validate_count=%d reference=%ld",
+          len, len ? s[0] : 0, ok, expect);
+    CHECK(utf8_is_valid(s, len) == ok, "len=%zu: is_valid disagrees with validate_count", len);
+    if (ok) {
+        CHECK(count == (size_t)expect, "len=%zu: count=%zu reference=%ld", len, count, expect);
+        CHECK(legacy_utf8_is_valid(s, len), "len=%zu first=%02X: accepted by new, rejected by legacy",
+              len, s[0]);
+    } else {
+        CHECK(count == (size_t)-1, "len=%zu: count modified on invalid input", len);
+    }
+}
+
+// 1~3字节的全部组合，覆盖所有首字节与续字节边界
+static void test_short_sequences(void)
+{
+    uint8_t s[3];
+    for (int a = 0; a < 256; a++) {
+        s[0] = a;
+        compare(s, 1);
+        for (int b = 0; b < 256; b++) {
+            s[1] = b;
+            compare(s, 2);
+            for (int c = 0; c < 256; c++) {
+                s[2] = c;
+                compare(s, 3);
+            }
+        }
+    }
+}
+
+// 4字节：首字节取 0xE0~0xFF，续字节取各边界值
+static void test_four_byte_boundaries(void)
+{
+    static const uint8_t edges[] = {
+        0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xE0, 0xF4, 0xFF,
+    };
+    const size_t ne = sizeof(edges);
+    uint8_t s[4];
+    for (int a = 0xE0; a < 256; a++) {
+        s[0] = a;
+        for (size_t b = 0; b < ne; b++) {
+            for (size_t c = 0; c < ne; c++) {
+                for (size_t d = 0; d < ne; d++) {
+                    s[1] = edges[b];
+                    s[2] = edges[c];
+                    s[3] = edges[d];
+                    compare(s, 4);
+                }
+            }
+        }
+    }
+}
+
+// 长ASCII串中在每个位置、每种起始对齐放入非ASCII序列，检验8字节跳过与逐字节尾部的衔接
+static void test_ascii_skip(void)
+{
+    static const struct { const char *bytes; size_t len; } inserts[] = {
+        { "\xE5\xAE\xAB", 3 },      // 宫
+        { "\xF0\x9F\x8D\x9C", 4 },  // U+1F35C
+        { "\x80", 1 },              // 孤立续字节
+        { "\xC0\xAF", 2 },          // 超长编码
+        { "\xED\xA0\x80", 3 },      // 代理区
+        { "\xE5\xAE", 2 },          // 截断
+    };
+    uint8_t buf[96 + 8];
+    for (size_t align = 0; align < 8; align++) {
+        for (size_t k = 0; k < sizeof(inserts) / sizeof(inserts[0]); k++) {
+            for (size_t pos = 0; pos + inserts[k].len <= 96; pos++) {
+                uint8_t *s = buf + align;
+                memset(s, 'a', 96);
+                memcpy(s + pos, inserts[k].bytes, inserts[k].len);
+                compare(s, 96);
+                compare(s, pos + inserts[k].len);
+            }
+        }
+    }
+}
+
+// 随机输入：偏向UTF-8前导/续字节，使有效与无效序列都有足够比例
+static void test_random(void)
+{
+    static const uint8_t pool[] = {
+        'a', 'Z', 0x00, 0x7F, 0x80, 0xA0, 0xBF, 0xC2, 0xDF, 0xE0, 0xE5, 0xED, 0xEF, 0xF0, 0xF4, 0xF5,
+    };
+    uint8_t s[64];
+    srand(12345);
+    for (int iter = 0; iter < 200000; iter++) {
+        size_t len = rand() % sizeof(s);
+        for (size_t i = 0; i < len; i++) {
+            s[i] = (rand() & 1) ? pool[rand() % sizeof(pool)] : 0x80 | (rand() & 0x3F);
+        }
+        compare(s, len);
+    }
+}
+
+static void test_stricter_than_legacy(void)
+{
+    static const struct { const char *bytes; size_t len; } cases[] = {
+        { "\xC0\x80", 2 },              // 超长 NUL
+        { "\xE0\x80\xAF", 3 },          // 超长 '/'
+        { "\xED\xA0\x80", 3 },          // U+D800
+        { "\xF4\x90\x80\x80", 4 },      // U+110000
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const uint8_t *s = (const uint8_t *)cases[i].bytes;
+        CHECK(legacy_utf8_is_valid(s, cases[i].len), "case %zu: legacy should accept", i);
+        CHECK(!utf8_is_valid(s, cases[i].len), "case %zu: new validator should reject", i);
+    }
+}
+
+// 有效文本的每个前缀截断后，结果应为不超过该长度的最后一个字符边界
+static void test_trim(void)
+{
+    static const char text[] = "a宫保\xF0\x9F\x8D\x9C鸡丁、少辣x2";
+    const uint8_t *s = (const uint8_t *)text;
+    size_t len = sizeof(text) - 1;
+
+    for (size_t cut = 0; cut <= len; cut++) {
+        size_t boundary = cut;
+        while (boundary > 0 && boundary < len && (s[boundary] & 0xC0) == 0x80) {
+            boundary--;
+        }
+        size_t trimmed = utf8_trim_len(s, cut);
+        CHECK(trimmed == boundary, "cut=%zu: trimmed to %zu, expected %zu", cut, trimmed, boundary);
+        CHECK(utf8_is_valid(s, trimmed), "cut=%zu: trimmed prefix is not valid UTF-8", cut);
+    }
+}
+
+int main(void)
+{
+    test_short_sequences();
+    test_four_byte_boundaries();
+    test_ascii_skip();
+    test_random();
+    test_stricter_than_legacy();
+    test_trim();
+
+    if (s_failures) {
+        printf("%d failure(s)\n", s_failures);
+        return 1;
+    }
+    printf("test_utf8: all passed\n");
+    return 0;
+}
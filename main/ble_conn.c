@@ -0,0 +1,89 @@
+#include "ble_conn.h"
+#include "esp_log.h"
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+
+static const char *TAG = "BleConn";
+
+static ble_conn_t s_conns[BLE_CONN_MAX];
+static int s_count = 0;
+static portMUX_TYPE s_conn_lock = portMUX_INITIALIZER_UNLOCKED;  // 保护 in_use/subscribed，供UI任务读取
+
+esp_err_t ble_conn_add(uint16_t conn_handle)
+{
+    ble_conn_t *conn = ble_conn_find(conn_handle);
+    for (int i = 0; !conn && i < BLE_CONN_MAX; i++) {
+        if (!s_conns[i].in_use) {
+            conn = &s_conns[i];
+        }
+    }
+    if (!conn) {
+        ESP_LOGW(TAG, "连接表已满: conn=%d", conn_handle);
+        return ESP_ERR_NO_MEM;
+    }
+
+    taskENTER_CRITICAL(&s_conn_lock);
+    if (!conn->in_use) {
+        s_count++;
+    }
+    memset(conn, 0, sizeof(*conn));
+    conn->in_use = true;
+    conn->conn_handle = conn_handle;
+    taskEXIT_CRITICAL(&s_conn_lock);
+
+    ESP_LOGI(TAG, "连接已登记: conn=%d (%d/%d)", conn_handle, s_count, BLE_CONN_MAX);
+    return ESP_OK;
+}
+
+void ble_conn_remove(uint16_t conn_handle)
+{
+    ble_conn_t *conn = ble_conn_find(conn_handle);
+    if (!conn) return;
+
+    taskENTER_CRITICAL(&s_conn_lock);
+    conn->in_use = false;
+    conn->subscribed = false;
+    s_count--;
+    taskEXIT_CRITICAL(&s_conn_lock);
+
+    ESP_LOGI(TAG, "连接已移除: conn=%d (%d/%d)", conn_handle, s_count, BLE_CONN_MAX);
+}
+
+ble_conn_t *ble_conn_find(uint16_t conn_handle)
+{
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        if (s_conns[i].in_use && s_conns[i].conn_handle == conn_handle) {
+            return &s_conns[i];
+        }
+    }
+    return NULL;
+}
+
+void ble_conn_set_subscribed(uint16_t conn_handle, bool subscribed)
+{
+    ble_conn_t *conn = ble_conn_find(conn_handle);
+    if (!conn) return;
+
+    taskENTER_CRITICAL(&s_conn_lock);
+    conn->subscribed = subscribed;
+    taskEXIT_CRITICAL(&s_conn_lock);
+}
+
+int ble_conn_count(void)
+{
+    return s_count;
+}
+
+int ble_conn_subscribed(uint16_t *handles, int max)
+{
+    int n = 0;
+
+    taskENTER_CRITICAL(&s_conn_lock);
+    for (int i = 0; i < BLE_CONN_MAX && n < max; i++) {
+        if (s_conns[i].in_use && s_conns[i].subscribed) {
+            handles[n++] = s_conns[i].conn_handle;
+        }
+    }
+    taskEXIT_CRITICAL(&s_conn_lock);
+    return n;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file ble_conn.h
+ * @brief 多连接状态表
+ *
+ * 每个已连接的POS平板占一个固定槽位，保存连接句柄、通知订阅状态与链路参数。
+ * 表项的增删与链路参数只在NimBLE主机任务中修改；订阅快照可在任意任务中读取。
+ */
+
+#ifndef BLE_CONN_H
+#define BLE_CONN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "ble_conn_tuning.h"
+
+#define BLE_CONN_MAX CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+
+typedef struct {
+    bool in_use;
+    bool subscribed;            // 是否订阅了出餐完成通知
+    uint16_t conn_handle;
+    ble_link_status_t link;     // 协商参数与实测吞吐（由 ble_conn_tuning 维护）
+    int64_t burst_start_us;
+    int64_t burst_last_us;
+} ble_conn_t;
+
+/**
+ * @brief 登记新连接
+ *
+ * @return ESP_ERR_NO_MEM 表已满
+ */
+esp_err_t ble_conn_add(uint16_t conn_handle);
+
+/**
+ * @brief 移除连接
+ */
+void ble_conn_remove(uint16_t conn_handle);
+
+/**
+ * @brief 查找连接（仅主机任务中使用返回的指针）
+ */
+ble_conn_t *ble_conn_find(uint16_t conn_handle);
+
+/**
+ * @brief 更新通知订阅状态
+ */
+void ble_conn_set_subscribed(uint16_t conn_handle, bool subscribed);
+
+/**
+ * @brief 当前连接数
+ */
+int ble_conn_count(void);
+
+/**
+ * @brief 复制已订阅通知的连接句柄
+ *
+ * @return 句柄数量
+ */
+int ble_conn_subscribed(uint16_t *handles, int max);
+
+#endif // BLE_CONN_H
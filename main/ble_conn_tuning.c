@@ -0,0 +1,215 @@
+#include "ble_conn_tuning.h"
+#include "ble_conn.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "host/ble_hs.h"
+#include "host/ble_gap.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "ConnTuning";
+
+#define TUNING_DATA_LEN_OCTETS  251
+#define TUNING_DATA_LEN_TIME    2120    // 251字节在1M PHY上的传输时间(us)
+#define TUNING_BURST_GAP_US     500000  // 两次写入间隔超过该值视为新一轮写入
+#define TUNING_FAST_TIMEOUT     400     // 监督超时 4s
+#define TUNING_IDLE_TIMEOUT     600     // 监督超时 6s
+
+// 时钟未同步前按营业时段处理，保证开机后首个订单低延迟
+static ble_tuning_policy_t current_policy(void)
+{
+    time_t now = time(NULL);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    if (tm_now.tm_year + 1900 < 2024) {
+        return BLE_TUNING_POLICY_FAST;
+    }
+
+    int start = CONFIG_KDS_BLE_SERVICE_START_HOUR;
+    int end = CONFIG_KDS_BLE_SERVICE_END_HOUR;
+    int hour = tm_now.tm_hour;
+    bool in_service = start <= end ? (hour >= start && hour < end)
+                                   : (hour >= start || hour < end);  // 跨午夜
+    return in_service ? BLE_TUNING_POLICY_FAST : BLE_TUNING_POLICY_IDLE;
+}
+
+static void request_conn_params(ble_conn_t *conn, ble_tuning_policy_t policy)
+{
+    struct ble_gap_upd_params params = {0};
+    if (policy == BLE_TUNING_POLICY_FAST) {
+        params.itvl_min = CONFIG_KDS_BLE_FAST_ITVL_MIN;
+        params.itvl_max = CONFIG_KDS_BLE_FAST_ITVL_MAX;
+        params.latency = 0;
+        params.supervision_timeout = TUNING_FAST_TIMEOUT;
+    } else {
+        params.itvl_min = CONFIG_KDS_BLE_IDLE_ITVL_MIN;
+        params.itvl_max = CONFIG_KDS_BLE_IDLE_ITVL_MAX;
+        params.latency = CONFIG_KDS_BLE_IDLE_LATENCY;
+        params.supervision_timeout = TUNING_IDLE_TIMEOUT;
+    }
+
+    conn->link.policy = policy;
+    int rc = ble_gap_update_params(conn->link.conn_handle, &params);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "请求连接参数失败; rc=%d", rc);
+        return;
+    }
+    ESP_LOGI(TAG, "请求%s连接参数: 间隔 %d-%d, 延迟 %d",
+             policy == BLE_TUNING_POLICY_FAST ? "低延迟" : "省电",
+             params.itvl_min, params.itvl_max, params.latency);
+}
+
+static void refresh_conn_desc(ble_conn_t *conn)
+{
+    struct ble_gap_conn_desc desc;
+    if (ble_gap_conn_find(conn->link.conn_handle, &desc) == 0) {
+        conn->link.itvl = desc.conn_itvl;
+        conn->link.latency = desc.conn_latency;
+        conn->link.supervision_timeout = desc.supervision_timeout;
+    }
+}
+
+void ble_conn_tuning_on_connect(uint16_t conn_handle)
+{
+    ble_conn_t *conn = ble_conn_find(conn_handle);
+    if (!conn) {
+        return;
+    }
+
+    conn->link.conn_handle = conn_handle;
+    conn->link.mtu = ble_att_mtu(conn_handle);
+    conn->link.tx_octets = 27;
+    conn->link.rx_octets = 27;
+    conn->link.tx_phy = 1;
+    conn->link.rx_phy = 1;
+    refresh_conn_desc(conn);
+
+    // 由外设主动发起，避免等待中心设备（部分平板从不发起MTU交换）
+    int rc = ble_gattc_exchange_mtu(conn_handle, NULL, NULL);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "MTU交换失败; rc=%d", rc);
+    }
+
+#if CONFIG_KDS_BLE_DATA_LEN_EXT
+    rc = ble_gap_set_data_len(conn_handle, TUNING_DATA_LEN_OCTETS, TUNING_DATA_LEN_TIME);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "数据长度扩展请求失败; rc=%d", rc);
+    }
+#endif
+
+#if CONFIG_KDS_BLE_PREFER_2M_PHY
+    rc = ble_gap_set_prefered_le_phy(conn_handle, BLE_GAP_LE_PHY_2M_MASK,
+                                     BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "2M PHY请求失败; rc=%d", rc);
+    }
+#endif
+
+    request_conn_params(conn, current_policy());
+}
+
+void ble_conn_tuning_on_gap_event(const struct ble_gap_event *event)
+{
+    ble_conn_t *conn;
+
+    switch (event->type) {
+    case BLE_GAP_EVENT_MTU:
+        conn = ble_conn_find(event->mtu.conn_handle);
+        if (conn) {
+            conn->link.mtu = event->mtu.value;
+        }
+        ESP_LOGI(TAG, "MTU更新: conn=%d, %d", event->mtu.conn_handle, event->mtu.value);
+        break;
+
+    case BLE_GAP_EVENT_CONN_UPDATE:
+        conn = ble_conn_find(event->conn_update.conn_handle);
+        if (conn) {
+            refresh_conn_desc(conn);
+            ESP_LOGI(TAG, "连接参数更新: status=%d, 间隔 %d.%02d ms, 延迟 %d, 超时 %d ms",
+                     event->conn_update.status, conn->link.itvl * 5 / 4, (conn->link.itvl * 125) % 100,
+                     conn->link.latency, conn->link.supervision_timeout * 10);
+        }
+        break;
+
+#ifdef BLE_GAP_EVENT_PHY_UPDATE_COMPLETE
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+        conn = ble_conn_find(event->phy_updated.conn_handle);
+        if (conn && event->phy_updated.status == 0) {
+            conn->link.tx_phy = event->phy_updated.tx_phy;
+            conn->link.rx_phy = event->phy_updated.rx_phy;
+        }
+        ESP_LOGI(TAG, "PHY更新: status=%d, tx=%d, rx=%d", event->phy_updated.status,
+                 event->phy_updated.tx_phy, event->phy_updated.rx_phy);
+        break;
+#endif
+
+#ifdef BLE_GAP_EVENT_DATA_LEN_CHG
+    case BLE_GAP_EVENT_DATA_LEN_CHG:
+        conn = ble_conn_find(event->data_len_chg.conn_handle);
+        if (conn) {
+            conn->link.tx_octets = event->data_len_chg.max_tx_octets;
+            conn->link.rx_octets = event->data_len_chg.max_rx_octets;
+        }
+        ESP_LOGI(TAG, "数据长度更新: tx=%d, rx=%d", event->data_len_chg.max_tx_octets,
+                 event->data_len_chg.max_rx_octets);
+        break;
+#endif
+
+    default:
+        break;
+    }
+}
+
+void ble_conn_tuning_note_rx(uint16_t conn_handle, uint16_t len)
+{
+    ble_conn_t *conn = ble_conn_find(conn_handle);
+    if (!conn) return;
+
+    int64_t now = esp_timer_get_time();
+    if (conn->burst_last_us == 0 || now - conn->burst_last_us > TUNING_BURST_GAP_US) {
+        // 新一轮写入：营业时段切换后在此调整连接参数
+        conn->burst_start_us = now;
+        conn->link.burst_bytes = 0;
+        ble_tuning_policy_t policy = current_policy();
+        if (policy != conn->link.policy) {
+            request_conn_params(conn, policy);
+        }
+    }
+
+    conn->burst_last_us = now;
+    conn->link.burst_bytes += len;
+
+    int64_t elapsed = now - conn->burst_start_us;
+    if (elapsed > 0) {
+        conn->link.burst_kbps = (uint32_t)((int64_t)conn->link.burst_bytes * 8000 / elapsed);
+    }
+}
+
+esp_err_t ble_conn_tuning_get(uint16_t conn_handle, ble_link_status_t *status)
+{
+    ble_conn_t *conn = ble_conn_find(conn_handle);
+    if (!conn || !status) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *status = conn->link;
+    return ESP_OK;
+}
+
+int ble_conn_tuning_status_json(uint16_t conn_handle, char *buf, size_t size)
+{
+    ble_link_status_t st;
+    if (ble_conn_tuning_get(conn_handle, &st) != ESP_OK) {
+        return snprintf(buf, size, "{\"conn\":null}");
+    }
+
+    // 连接间隔以微秒输出，避免浮点
+    return snprintf(buf, size,
+                    "{\"conn\":%d,\"policy\":\"%s\",\"mtu\":%d,\"dl\":[%d,%d],\"phy\":[%d,%d],"
+                    "\"itvl_us\":%lu,\"lat\":%d,\"to_ms\":%d,\"burst\":%lu,\"kbps\":%lu}",
+                    st.conn_handle, st.policy == BLE_TUNING_POLICY_FAST ? "fast" : "idle",
+                    st.mtu, st.tx_octets, st.rx_octets, st.tx_phy, st.rx_phy,
+                    (unsigned long)st.itvl * 1250, st.latency, st.supervision_timeout * 10,
+                    (unsigned long)st.burst_bytes, (unsigned long)st.burst_kbps);
+}
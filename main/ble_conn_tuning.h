@@ -0,0 +1,71 @@
+/**
+ * @file ble_conn_tuning.h
+ * @brief 连接参数调优：MTU交换、数据长度扩展、2M PHY与连接间隔策略
+ *
+ * 连接建立后按当前时段选择策略（营业时段低延迟，空闲时段省电），
+ * 按连接分别记录协商结果与实测吞吐，供状态特征读取。所有接口都在NimBLE主机任务中调用。
+ */
+
+#ifndef BLE_CONN_TUNING_H
+#define BLE_CONN_TUNING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+struct ble_gap_event;
+
+typedef enum {
+    BLE_TUNING_POLICY_FAST = 0,     // 营业时段：短连接间隔，无从机延迟
+    BLE_TUNING_POLICY_IDLE,         // 空闲时段：长连接间隔，允许从机延迟
+} ble_tuning_policy_t;
+
+// 协商得到的链路参数
+typedef struct {
+    uint16_t conn_handle;
+    ble_tuning_policy_t policy;
+    uint16_t mtu;
+    uint16_t tx_octets;             // 数据长度扩展后的单包字节数
+    uint16_t rx_octets;
+    uint8_t tx_phy;                 // 1=1M, 2=2M, 3=Coded
+    uint8_t rx_phy;
+    uint16_t itvl;                  // 连接间隔，1.25ms单位
+    uint16_t latency;
+    uint16_t supervision_timeout;   // 10ms单位
+    uint32_t burst_bytes;           // 最近一次连续写入的字节数
+    uint32_t burst_kbps;            // 最近一次连续写入的实测吞吐
+} ble_link_status_t;
+
+/**
+ * @brief 连接建立后发起MTU交换、数据长度扩展、PHY与连接参数请求
+ *
+ * 连接须已通过 ble_conn_add 登记，链路参数保存在连接表中，断开时随表项一起清除。
+ */
+void ble_conn_tuning_on_connect(uint16_t conn_handle);
+
+/**
+ * @brief 记录 MTU / 连接参数 / PHY / 数据长度 变化事件
+ */
+void ble_conn_tuning_on_gap_event(const struct ble_gap_event *event);
+
+/**
+ * @brief 统计一次订单写入，用于计算实测吞吐；新一轮写入时重新评估策略
+ */
+void ble_conn_tuning_note_rx(uint16_t conn_handle, uint16_t len);
+
+/**
+ * @brief 获取当前链路参数
+ *
+ * @return ESP_ERR_NOT_FOUND 没有连接
+ */
+esp_err_t ble_conn_tuning_get(uint16_t conn_handle, ble_link_status_t *status);
+
+/**
+ * @brief 生成链路状态JSON（状态特征 0x1236 读取）
+ *
+ * @return 写入的字节数
+ */
+int ble_conn_tuning_status_json(uint16_t conn_handle, char *buf, size_t size);
+
+#endif // BLE_CONN_TUNING_H
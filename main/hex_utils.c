@@ -1,38 +1,96 @@
 #include "hex_utils.h"
-#include <ctype.h>
 #include <string.h>
 
+// 查找表：有效字符为 0x10 | 数值，其余为 0，按位与即可一次检查多个字符
+#define HEX_VALID 0x10
+
+static const uint8_t s_hex_table[256] = {
+    ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14,
+    ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17, ['8'] = 0x18, ['9'] = 0x19,
+    ['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+    ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+};
+
+static inline uint8_t hex_pair(uint8_t hi, uint8_t lo) {
+    return (uint8_t)(hi << 4) | (lo & 0x0F);
+}
+
 /* 十六进制字符转换为数值 */
 uint8_t hex_char_to_value(char c) {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    return 0;
+    return s_hex_table[(uint8_t)c] & 0x0F;
 }
 
 /* 检查字符串是否为有效的十六进制 */
 bool hex_is_valid(const char *str) {
-    for (int i = 0; str[i]; i++) {
-        if (!isxdigit((unsigned char)str[i])) {
-            return false;
-        }
-    }
-    return true;
+    return hex_is_valid_n(str, strlen(str));
 }
 
 /* 十六进制字符串转换为普通字符串 */
 int hex_to_ascii(const char *hex, char *output, size_t output_size) {
-    int hex_len = strlen(hex);
+    size_t hex_len = strlen(hex);
     if (hex_len % 2 != 0 || output_size < hex_len / 2 + 1) {
         return -1;
     }
-    
-    int j = 0;
-    for (int i = 0; i < hex_len; i += 2) {
-        uint8_t high = hex_char_to_value(hex[i]);
-        uint8_t low = hex_char_to_value(hex[i + 1]);
-        output[j++] = (high << 4) | low;
+
+    // 保持原有行为：非十六进制字符按0处理
+    size_t j = 0;
+    for (size_t i = 0; i < hex_len; i += 2) {
+        output[j++] = hex_pair(s_hex_table[(uint8_t)hex[i]], s_hex_table[(uint8_t)hex[i + 1]]);
     }
     output[j] = '\0';
     return j;
-}
\ No newline at end of file
+}
+
+/* 检查指定长度的内容是否为有效的十六进制 */
+bool hex_is_valid_n(const char *hex, size_t len) {
+    const uint8_t *p = (const uint8_t *)hex;
+    uint8_t acc = HEX_VALID;
+    size_t i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        acc &= s_hex_table[p[i]] & s_hex_table[p[i + 1]] & s_hex_table[p[i + 2]] & s_hex_table[p[i + 3]] &
+               s_hex_table[p[i + 4]] & s_hex_table[p[i + 5]] & s_hex_table[p[i + 6]] & s_hex_table[p[i + 7]];
+        if (!(acc & HEX_VALID)) {
+            return false;
+        }
+    }
+    for (; i < len; i++) {
+        acc &= s_hex_table[p[i]];
+    }
+    return (acc & HEX_VALID) != 0;
+}
+
+/* 单遍校验并解码十六进制 */
+int hex_decode(const char *hex, size_t hex_len, uint8_t *out, size_t out_size) {
+    if (hex_len % 2 != 0 || hex_len / 2 > out_size) {
+        return -1;
+    }
+
+    const uint8_t *p = (const uint8_t *)hex;
+    size_t i = 0;
+    size_t j = 0;
+
+    // 每次8个字符：先查表，一次分支判断有效性，再写出4个字节
+    for (; i + 8 <= hex_len; i += 8, j += 4) {
+        uint8_t v0 = s_hex_table[p[i]],     v1 = s_hex_table[p[i + 1]];
+        uint8_t v2 = s_hex_table[p[i + 2]], v3 = s_hex_table[p[i + 3]];
+        uint8_t v4 = s_hex_table[p[i + 4]], v5 = s_hex_table[p[i + 5]];
+        uint8_t v6 = s_hex_table[p[i + 6]], v7 = s_hex_table[p[i + 7]];
+        if (!(v0 & v1 & v2 & v3 & v4 & v5 & v6 & v7 & HEX_VALID)) {
+            return -1;
+        }
+        out[j] = hex_pair(v0, v1);
+        out[j + 1] = hex_pair(v2, v3);
+        out[j + 2] = hex_pair(v4, v5);
+        out[j + 3] = hex_pair(v6, v7);
+    }
+
+    for (; i < hex_len; i += 2, j++) {
+        uint8_t hi = s_hex_table[p[i]], lo = s_hex_table[p[i + 1]];
+        if (!(hi & lo & HEX_VALID)) {
+            return -1;
+        }
+        out[j] = hex_pair(hi, lo);
+    }
+    return j;
+}
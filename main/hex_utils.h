@@ -14,4 +14,20 @@ bool hex_is_valid(const char *str);
 // 十六进制字符串转换为普通字符串
 int hex_to_ascii(const char *hex, char *output, size_t output_size);
 
-#endif // HEX_UTILS_H
\ No newline at end of file
+/**
+ * @brief 检查指定长度的内容是否全为十六进制字符
+ */
+bool hex_is_valid_n(const char *hex, size_t len);
+
+/**
+ * @brief 单遍校验并解码十六进制（查表，每次处理8个字符）
+ *
+ * @param hex 输入，不要求NUL结尾
+ * @param hex_len 输入长度，必须为偶数
+ * @param out 输出缓冲区，可与 hex 相同（就地解码，失败时内容不确定）
+ * @param out_size 输出缓冲区大小，不写结尾NUL
+ * @return 解码得到的字节数；遇到非十六进制字符、长度为奇数或空间不足时返回-1
+ */
+int hex_decode(const char *hex, size_t hex_len, uint8_t *out, size_t out_size);
+
+#endif // HEX_UTILS_H
@@ -0,0 +1,367 @@
+#include "menu_catalog.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "MenuCatalog";
+
+#define CATALOG_MAGIC       0x32554E4DU     // "MNU2"，工位以 ORDER_STATION_UNSET 表示未指定（MNU1 为0）
+#define CATALOG_BANKS       2
+
+// 存储体布局: [头部][索引 MENU_CATALOG_MAX_ID 项][菜名区]，头部最后写入
+typedef struct {
+    uint32_t magic;
+    uint32_t generation;    // 每次写入递增，启动时取有效且最新的存储体
+    uint32_t version;       // POS下发的菜单版本
+    uint16_t max_id;
+    uint16_t count;
+    uint32_t names_len;
+    uint32_t crc;           // 索引与菜名区的CRC32
+    uint32_t reserved[2];
+} catalog_header_t;
+
+typedef struct {
+    uint32_t name_off;      // 菜名区内偏移
+    uint8_t name_len;       // 0 表示该ID未定义
+    uint8_t glyphs;
+    uint8_t station;
+    uint8_t category;
+} catalog_slot_t;
+
+#define CATALOG_INDEX_SIZE  (sizeof(catalog_slot_t) * MENU_CATALOG_MAX_ID)
+#define CATALOG_BODY_OFF    sizeof(catalog_header_t)
+
+_Static_assert(sizeof(catalog_header_t) == 32, "目录头部应为32字节");
+_Static_assert(sizeof(catalog_header_t) + CATALOG_INDEX_SIZE + MENU_CATALOG_NAMES_MAX <= MENU_CATALOG_BANK_SIZE,
+               "目录超出存储体大小");
+
+static const esp_partition_t *s_part = NULL;
+
+// 当前生效的目录（映射的flash）
+static esp_partition_mmap_handle_t s_map;
+static bool s_mapped = false;
+static int s_bank = -1;
+static uint32_t s_generation = 0;
+static const catalog_slot_t *s_slots = NULL;
+static const char *s_names = NULL;
+static volatile uint32_t s_version = 0;
+static uint16_t s_count = 0;
+
+// 正在接收的目录，在PSRAM中按存储体布局拼装
+static uint8_t *s_stage = NULL;
+static uint32_t s_stage_version = 0;
+static uint8_t s_stage_next = 0;
+static uint8_t s_stage_parts = 0;
+static uint32_t s_stage_names_len = 0;
+
+static size_t image_size(uint32_t names_len)
+{
+    return CATALOG_BODY_OFF + CATALOG_INDEX_SIZE + names_len;
+}
+
+static size_t bank_offset(int bank)
+{
+    return MENU_CATALOG_REGION_OFFSET + bank * MENU_CATALOG_BANK_SIZE;
+}
+
+static void unmap_current(void)
+{
+    if (s_mapped) {
+        esp_partition_munmap(s_map);
+        s_mapped = false;
+    }
+    s_slots = NULL;
+    s_names = NULL;
+    s_version = 0;
+    s_count = 0;
+    s_bank = -1;
+}
+
+// 映射存储体并校验，成功后成为当前目录
+static bool map_bank(int bank, const catalog_header_t *hdr)
+{
+    const void *ptr;
+    esp_partition_mmap_handle_t handle;
+    size_t size = image_size(hdr->names_len);
+
+    if (esp_partition_mmap(s_part, bank_offset(bank), size, ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "映射目录存储体 %d 失败", bank);
+        return false;
+    }
+
+    const uint8_t *body = (const uint8_t *)ptr + CATALOG_BODY_OFF;
+    if (esp_rom_crc32_le(0, body, CATALOG_INDEX_SIZE + hdr->names_len) != hdr->crc) {
+        ESP_LOGW(TAG, "目录存储体 %d 校验失败", bank);
+        esp_partition_munmap(handle);
+        return false;
+    }
+
+    unmap_current();
+    s_map = handle;
+    s_mapped = true;
+    s_bank = bank;
+    s_generation = hdr->generation;
+    s_slots = (const catalog_slot_t *)body;
+    s_names = (const char *)body + CATALOG_INDEX_SIZE;
+    s_count = hdr->count;
+    s_version = hdr->version;
+    return true;
+}
+
+static bool read_header(int bank, catalog_header_t *hdr)
+{
+    if (esp_partition_read(s_part, bank_offset(bank), hdr, sizeof(*hdr)) != ESP_OK) {
+        return false;
+    }
+    return hdr->magic == CATALOG_MAGIC && hdr->max_id == MENU_CATALOG_MAX_ID &&
+           hdr->names_len <= MENU_CATALOG_NAMES_MAX;
+}
+
+esp_err_t menu_catalog_init(void)
+{
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    if (!s_part) {
+        ESP_LOGW(TAG, "未找到 storage 分区，菜品目录不可用");
+        return ESP_OK;
+    }
+    if (s_part->size < MENU_CATALOG_REGION_OFFSET + MENU_CATALOG_REGION_SIZE) {
+        ESP_LOGE(TAG, "storage 分区过小: %u 字节", (unsigned)s_part->size);
+        s_part = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    catalog_header_t hdr[CATALOG_BANKS];
+    bool valid[CATALOG_BANKS];
+    for (int i = 0; i < CATALOG_BANKS; i++) {
+        valid[i] = read_header(i, &hdr[i]);
+    }
+
+    // 先尝试较新的存储体，校验失败再退回另一个
+    int first = (valid[1] && (!valid[0] || (int32_t)(hdr[1].generation - hdr[0].generation) > 0)) ? 1 : 0;
+    for (int k = 0; k < CATALOG_BANKS; k++) {
+        int bank = (first + k) % CATALOG_BANKS;
+        if (valid[bank] && map_bank(bank, &hdr[bank])) {
+            ESP_LOGI(TAG, "菜品目录: 版本 %u, %u 项 (存储体 %d)",
+                     (unsigned)s_version, s_count, bank);
+            return ESP_OK;
+        }
+    }
+
+    ESP_LOGI(TAG, "尚无菜品目录，等待POS同步");
+    return ESP_OK;
+}
+
+bool menu_catalog_lookup(uint16_t id, menu_entry_t *out)
+{
+    if (!s_slots || id == 0 || id >= MENU_CATALOG_MAX_ID) {
+        return false;
+    }
+
+    const catalog_slot_t *slot = &s_slots[id];
+    if (slot->name_len == 0) {
+        return false;
+    }
+
+    out->name = s_names + slot->name_off;
+    out->name_len = slot->name_len;
+    out->glyphs = slot->glyphs;
+    out->station = slot->station;
+    out->category = slot->category;
+    return true;
+}
+
+esp_err_t menu_catalog_fill_item(order_record_t *rec, uint16_t id, order_item_t *item)
+{
+    menu_entry_t entry;
+    bool found = menu_catalog_lookup(id, &entry);
+    char placeholder[8];
+
+    if (!found) {
+        entry.name_len = snprintf(placeholder, sizeof(placeholder), "#%u", id);
+        entry.name = placeholder;
+        entry.glyphs = entry.name_len;
+        entry.station = ORDER_STATION_UNSET;
+        entry.category = 0;
+    }
+
+    if (rec->text_len + entry.name_len + 1 > ORDER_TEXT_MAX) {
+        rec->truncated = true;
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(rec->text + rec->text_len, entry.name, entry.name_len);
+    rec->text[rec->text_len + entry.name_len] = '\0';
+    item->name_off = rec->text_len;
+    item->name_len = entry.name_len;
+    item->glyphs = entry.glyphs;
+    item->menu_id = id;
+    item->station = entry.station;
+    item->category = entry.category;
+    rec->text_len += entry.name_len + 1;
+
+    if (!found) {
+        ESP_LOGW(TAG, "目录中没有菜品ID %u", id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+static void stage_abort(void)
+{
+    if (s_stage) {
+        heap_caps_free(s_stage);
+        s_stage = NULL;
+    }
+    s_stage_next = 0;
+    s_stage_parts = 0;
+}
+
+static esp_err_t stage_begin(const order_record_t *rec)
+{
+    if (!s_stage) {
+        s_stage = heap_caps_malloc(image_size(MENU_CATALOG_NAMES_MAX), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_stage) {
+            ESP_LOGE(TAG, "目录暂存区分配失败");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    memset(s_stage, 0, CATALOG_BODY_OFF + CATALOG_INDEX_SIZE);
+    s_stage_version = rec->menu_version;
+    s_stage_parts = rec->menu_parts ? rec->menu_parts : 1;
+    s_stage_next = 0;
+    s_stage_names_len = 0;
+    return ESP_OK;
+}
+
+static esp_err_t stage_entries(const order_record_t *rec)
+{
+    catalog_slot_t *slots = (catalog_slot_t *)(s_stage + CATALOG_BODY_OFF);
+    char *names = (char *)s_stage + CATALOG_BODY_OFF + CATALOG_INDEX_SIZE;
+
+    for (int i = 0; i < rec->item_count; i++) {
+        const order_item_t *item = &rec->items[i];
+        if (item->menu_id == 0 || item->menu_id >= MENU_CATALOG_MAX_ID ||
+            item->name_len == 0 || item->name_len > MENU_CATALOG_NAME_MAX) {
+            ESP_LOGW(TAG, "忽略无效的目录项: id=%u, 名称%u字节", item->menu_id, item->name_len);
+            continue;
+        }
+        if (s_stage_names_len + item->name_len + 1 > MENU_CATALOG_NAMES_MAX) {
+            ESP_LOGE(TAG, "菜名总量超过 %d 字节", MENU_CATALOG_NAMES_MAX);
+            return ESP_ERR_NO_MEM;
+        }
+
+        // 重复的ID以后出现的为准，旧名称留在菜名区不回收
+        memcpy(names + s_stage_names_len, order_record_item_name(rec, i), item->name_len);
+        names[s_stage_names_len + item->name_len] = '\0';
+
+        catalog_slot_t *slot = &slots[item->menu_id];
+        slot->name_off = s_stage_names_len;
+        slot->name_len = item->name_len;
+        slot->glyphs = item->glyphs > UINT8_MAX ? UINT8_MAX : item->glyphs;
+        slot->station = item->station;
+        slot->category = item->category;
+        s_stage_names_len += item->name_len + 1;
+    }
+    return ESP_OK;
+}
+
+// 写入另一个存储体，成功后切换映射
+static esp_err_t stage_commit(void)
+{
+    catalog_header_t *hdr = (catalog_header_t *)s_stage;
+    const catalog_slot_t *slots = (const catalog_slot_t *)(s_stage + CATALOG_BODY_OFF);
+    size_t body_len = CATALOG_INDEX_SIZE + s_stage_names_len;
+    int bank = s_bank < 0 ? 0 : (s_bank + 1) % CATALOG_BANKS;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = CATALOG_MAGIC;
+    hdr->generation = s_generation + 1;
+    hdr->version = s_stage_version;
+    hdr->max_id = MENU_CATALOG_MAX_ID;
+    hdr->names_len = s_stage_names_len;
+    for (int id = 1; id < MENU_CATALOG_MAX_ID; id++) {
+        hdr->count += slots[id].name_len != 0;
+    }
+    hdr->crc = esp_rom_crc32_le(0, s_stage + CATALOG_BODY_OFF, body_len);
+
+    size_t erase_len = (image_size(s_stage_names_len) + s_part->erase_size - 1) / s_part->erase_size * s_part->erase_size;
+    esp_err_t err = esp_partition_erase_range(s_part, bank_offset(bank), erase_len);
+    if (err == ESP_OK) {
+        err = esp_partition_write(s_part, bank_offset(bank) + CATALOG_BODY_OFF, s_stage + CATALOG_BODY_OFF, body_len);
+    }
+    if (err == ESP_OK) {
+        err = esp_partition_write(s_part, bank_offset(bank), hdr, sizeof(*hdr));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "写入目录存储体 %d 失败: %s", bank, esp_err_to_name(err));
+        return err;
+    }
+
+    if (!map_bank(bank, hdr)) {
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "菜品目录已更新: 版本 %u, %u 项, 菜名 %u 字节 (存储体 %d)",
+             (unsigned)s_version, s_count, (unsigned)s_stage_names_len, bank);
+    return ESP_OK;
+}
+
+esp_err_t menu_catalog_apply(const order_record_t *rec)
+{
+    if (!s_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (rec->truncated) {
+        ESP_LOGE(TAG, "目录分段超出记录容量（每段最多 %d 项），同步已放弃", ORDER_MAX_ITEMS);
+        stage_abort();
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err;
+    if (rec->menu_part == 0) {
+        if (s_stage_parts) {
+            ESP_LOGW(TAG, "放弃未完成的目录同步: 版本 %u (%d/%d)",
+                     (unsigned)s_stage_version, s_stage_next, s_stage_parts);
+        }
+        err = stage_begin(rec);
+        if (err != ESP_OK) {
+            stage_abort();
+            return err;
+        }
+    } else if (!s_stage_parts) {
+        ESP_LOGW(TAG, "没有进行中的目录同步，忽略分段 %d", rec->menu_part);
+        return ESP_ERR_INVALID_STATE;
+    } else if (rec->menu_part != s_stage_next || rec->menu_version != s_stage_version) {
+        ESP_LOGW(TAG, "目录分段乱序: 版本 %u 段 %d，期望版本 %u 段 %d",
+                 (unsigned)rec->menu_version, rec->menu_part, (unsigned)s_stage_version, s_stage_next);
+        stage_abort();
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    err = stage_entries(rec);
+    if (err != ESP_OK) {
+        stage_abort();
+        return err;
+    }
+
+    if (++s_stage_next < s_stage_parts) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    err = stage_commit();
+    stage_abort();
+    return err;
+}
+
+uint32_t menu_catalog_version(void)
+{
+    return s_version;
+}
+
+uint16_t menu_catalog_count(void)
+{
+    return s_count;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file menu_catalog.h
+ * @brief 菜品目录（ID → 名称）
+ *
+ * POS通过菜单同步消息把整份菜单下发一次，写入 storage 分区开头的目录区；
+ * 之后订单只携带菜品ID。启动时目录通过 esp_partition_mmap 映射，按ID直接索引，O(1)查找。
+ * 目录区分为两个存储体轮流写入，头部最后写入，同步中途掉电时旧目录仍然有效。
+ * 查找与同步都在解析任务中进行，不加锁。
+ */
+
+#ifndef MENU_CATALOG_H
+#define MENU_CATALOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "order_record.h"
+
+#define MENU_CATALOG_MAX_ID         1024            // 有效ID为 1 ~ MENU_CATALOG_MAX_ID-1
+#define MENU_CATALOG_NAME_MAX       255             // 单个菜名最大字节数
+#define MENU_CATALOG_NAMES_MAX      (64 * 1024)     // 全部菜名总字节数
+#define MENU_CATALOG_BANK_SIZE      (128 * 1024)
+#define MENU_CATALOG_REGION_OFFSET  0               // 在 storage 分区内的偏移
+#define MENU_CATALOG_REGION_SIZE    (2 * MENU_CATALOG_BANK_SIZE)
+
+typedef struct {
+    const char *name;       // 指向映射的flash，以NUL结尾
+    uint8_t name_len;
+    uint8_t glyphs;         // 名称的码点数
+    uint8_t station;        // 出品工位，ORDER_STATION_UNSET 表示未指定
+    uint8_t category;
+} menu_entry_t;
+
+/**
+ * @brief 映射 storage 分区中最新的有效目录
+ *
+ * 分区不存在或尚无目录时返回 ESP_OK，此时按ID下单的菜品显示为占位名称。
+ */
+esp_err_t menu_catalog_init(void);
+
+/**
+ * @brief 按ID查找菜品
+ *
+ * @return false ID未定义或尚无目录
+ */
+bool menu_catalog_lookup(uint16_t id, menu_entry_t *out);
+
+/**
+ * @brief 把目录中的菜品填入订单菜品，名称复制到记录的 text 区域
+ *
+ * 未知ID写入占位名称 "#ID"，返回 ESP_ERR_NOT_FOUND。
+ *
+ * @return ESP_OK 成功
+ * @return ESP_ERR_NOT_FOUND ID不在目录中（已写入占位名称）
+ * @return ESP_ERR_NO_MEM 记录文本区已满，置 truncated
+ */
+esp_err_t menu_catalog_fill_item(order_record_t *rec, uint16_t id, order_item_t *item);
+
+/**
+ * @brief 处理一条菜单同步消息（ORDER_MSG_MENU）
+ *
+ * 分段按顺序到达，全部收齐后写入flash并切换到新目录。
+ * 收到第0段时丢弃未完成的同步，重新开始。
+ *
+ * @return ESP_OK 新目录已生效
+ * @return ESP_ERR_NOT_FINISHED 等待后续分段
+ * @return ESP_ERR_INVALID_STATE 分段乱序或版本不一致，同步已放弃
+ * @return ESP_ERR_INVALID_SIZE 分段被截断（超过 ORDER_MAX_ITEMS 项），同步已放弃
+ * @return ESP_ERR_NO_MEM 菜名总量超过 MENU_CATALOG_NAMES_MAX
+ * @return 其他 flash写入错误
+ */
+esp_err_t menu_catalog_apply(const order_record_t *rec);
+
+/**
+ * @brief 当前目录的菜单版本，0 表示尚无目录（可在任意任务中读取）
+ */
+uint32_t menu_catalog_version(void);
+
+/**
+ * @brief 当前目录的菜品数
+ */
+uint16_t menu_catalog_count(void);
+
+#endif // MENU_CATALOG_H
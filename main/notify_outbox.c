@@ -0,0 +1,299 @@
+#include "notify_outbox.h"
+#include "ble_conn.h"
+#include "order_record.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "host/ble_hs.h"
+#include <stdio.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+static const char *TAG = "NotifyOutbox";
+
+#define OUTBOX_TASK_STACK_SIZE  4096
+#define OUTBOX_TASK_PRIORITY    4
+#define OUTBOX_BACKOFF_MIN_MS   10
+#define OUTBOX_BACKOFF_MAX_MS   500
+#define OUTBOX_IDLE_POLL_MS     1000    // 无订阅者时定期检查保留超时
+#define OUTBOX_PAYLOAD_MAX      512     // ATT属性值上限
+#define OUTBOX_WHOLE_ORDER      UINT8_MAX   // 整单确认，其余取值为工位号
+
+typedef struct {
+    char order_id[ORDER_ID_MAX_LEN];
+    uint8_t station;
+    int64_t posted_us;
+} outbox_entry_t;
+
+// 待发送确认的环形队列，UI任务写队尾，发件任务取队首
+static outbox_entry_t s_entries[NOTIFY_OUTBOX_LEN];
+static int s_head = 0;
+static int s_count = 0;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static notify_outbox_stats_t s_stats;
+static uint64_t s_latency_sum_ms = 0;
+
+// 正在发送的批次（仅发件任务访问）
+static char s_batch[OUTBOX_PAYLOAD_MAX + 1];
+static size_t s_batch_len = 0;
+static int s_batch_n = 0;                   // 批次包含队首的确认数，0表示没有批次
+static bool s_batch_delivered = false;      // 至少一个连接已收到
+static uint16_t s_targets[BLE_CONN_MAX];    // 尚未成功发送的连接
+static int s_target_count = 0;
+static int s_attempt = 0;
+static TickType_t s_next_try = 0;
+
+static int pending_count(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int count = s_count;
+    xSemaphoreGive(s_lock);
+    return count;
+}
+
+// 丢弃保留超时的确认，仅在没有进行中的批次时调用
+static void expire_old(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    while (s_count > 0 && now - s_entries[s_head].posted_us > (int64_t)NOTIFY_OUTBOX_RETAIN_MS * 1000) {
+        ESP_LOGW(TAG, "确认保留超时，已丢弃: %s", s_entries[s_head].order_id);
+        s_head = (s_head + 1) % NOTIFY_OUTBOX_LEN;
+        s_count--;
+        s_stats.dropped_expired++;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+// 所有目标连接中最小的可用负载
+static size_t payload_limit(void)
+{
+    size_t limit = OUTBOX_PAYLOAD_MAX;
+    for (int i = 0; i < s_target_count; i++) {
+        uint16_t mtu = ble_att_mtu(s_targets[i]);
+        if (mtu > 3 && (size_t)(mtu - 3) < limit) {
+            limit = mtu - 3;
+        }
+    }
+    return limit;
+}
+
+// 从队首取尽量多的整单确认合并为一条通知，工位确认单独发送；队首条目只由本任务移除，读取无需加锁
+static void build_batch(int avail)
+{
+    static const char tail[] = "],\"s\":true}";
+    const outbox_entry_t *head = &s_entries[s_head];
+    size_t limit = payload_limit();
+    size_t len;
+    int n = 0;
+
+    if (head->station != OUTBOX_WHOLE_ORDER) {
+        len = snprintf(s_batch, sizeof(s_batch), "{\"o\":\"%s\",\"st\":%u}", head->order_id, head->station);
+        n = 1;
+    } else {
+        len = snprintf(s_batch, sizeof(s_batch), "{\"o\":[");
+        for (; n < avail; n++) {
+            const outbox_entry_t *entry = &s_entries[(s_head + n) % NOTIFY_OUTBOX_LEN];
+            size_t need = strlen(entry->order_id) + 3 + (sizeof(tail) - 1);  // 引号、逗号与结尾
+            if (entry->station != OUTBOX_WHOLE_ORDER || (n > 0 && len + need > limit)) {
+                break;
+            }
+            len += snprintf(s_batch + len, sizeof(s_batch) - len, "%s\"%s\"", n > 0 ? "," : "", entry->order_id);
+        }
+
+        if (n == 1) {
+            // 单个确认保持原有格式，兼容旧版POS
+            len = snprintf(s_batch, sizeof(s_batch), "{\"o\":\"%s\",\"s\":true}", head->order_id);
+        } else {
+            len += snprintf(s_batch + len, sizeof(s_batch) - len, "%s", tail);
+        }
+    }
+
+    s_batch_len = len;
+    s_batch_n = n;
+    s_batch_delivered = false;
+    s_attempt = 0;
+}
+
+// 批次结束：移除队首 s_batch_n 个确认
+static void finish_batch(bool delivered)
+{
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < s_batch_n; i++) {
+        if (delivered) {
+            uint32_t ms = (now - s_entries[s_head].posted_us) / 1000;
+            s_latency_sum_ms += ms;
+            if (ms > s_stats.latency_max_ms) {
+                s_stats.latency_max_ms = ms;
+            }
+            s_stats.acked++;
+        } else {
+            s_stats.dropped_retry++;
+        }
+        s_head = (s_head + 1) % NOTIFY_OUTBOX_LEN;
+        s_count--;
+    }
+    xSemaphoreGive(s_lock);
+
+    s_batch_n = 0;
+}
+
+// 尽量发送所有待发确认，返回下次唤醒前的等待时间
+static TickType_t outbox_drain(void)
+{
+    for (;;) {
+        if (s_batch_n == 0) {
+            expire_old();
+            int avail = pending_count();
+            if (avail == 0) {
+                return portMAX_DELAY;
+            }
+            s_target_count = ble_conn_subscribed(s_targets, BLE_CONN_MAX);
+            if (s_target_count == 0) {
+                return pdMS_TO_TICKS(OUTBOX_IDLE_POLL_MS);
+            }
+            build_batch(avail);
+        } else if ((int32_t)(s_next_try - xTaskGetTickCount()) > 0) {
+            // 退避期间被新确认唤醒，不提前重试
+            return s_next_try - xTaskGetTickCount();
+        }
+
+        int remaining = 0;
+        for (int i = 0; i < s_target_count; i++) {
+            int rc = send_notification(s_targets[i], s_batch, s_batch_len);
+            if (rc == 0) {
+                s_stats.notifications++;
+                s_batch_delivered = true;
+            } else if (rc == BLE_HS_ENOMEM || rc == BLE_HS_EBUSY) {
+                s_targets[remaining++] = s_targets[i];
+            } else {
+                ESP_LOGW(TAG, "通知发送失败，放弃该连接: conn=%d, rc=%d", s_targets[i], rc);
+            }
+        }
+        s_target_count = remaining;
+
+        if (remaining > 0) {
+            if (++s_attempt > NOTIFY_OUTBOX_MAX_RETRIES) {
+                ESP_LOGE(TAG, "通知重试耗尽，丢弃 %d 个确认", s_batch_n);
+                finish_batch(s_batch_delivered);
+                continue;
+            }
+            s_stats.retries++;
+            uint32_t backoff = OUTBOX_BACKOFF_MIN_MS << (s_attempt - 1);
+            if (backoff > OUTBOX_BACKOFF_MAX_MS) {
+                backoff = OUTBOX_BACKOFF_MAX_MS;
+            }
+            s_next_try = xTaskGetTickCount() + pdMS_TO_TICKS(backoff);
+            return pdMS_TO_TICKS(backoff);
+        }
+
+        if (!s_batch_delivered) {
+            // 所有订阅者都已断开，保留确认等待重连
+            s_batch_n = 0;
+            return pdMS_TO_TICKS(OUTBOX_IDLE_POLL_MS);
+        }
+        finish_batch(true);
+    }
+}
+
+static void outbox_task(void *arg)
+{
+    TickType_t wait = portMAX_DELAY;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        wait = outbox_drain();
+    }
+}
+
+esp_err_t notify_outbox_init(void)
+{
+    if (s_task) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) {
+        ESP_LOGE(TAG, "创建发件箱互斥锁失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(outbox_task, "notify_outbox", OUTBOX_TASK_STACK_SIZE,
+                    NULL, OUTBOX_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建发件任务失败");
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t outbox_post(const char *order_id, uint8_t station)
+{
+    if (!s_lock || !order_id || !order_id[0]) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 同一订单（同一工位）的确认只保留一份
+    for (int i = 0; i < s_count; i++) {
+        const outbox_entry_t *entry = &s_entries[(s_head + i) % NOTIFY_OUTBOX_LEN];
+        if (entry->station == station && strcmp(entry->order_id, order_id) == 0) {
+            xSemaphoreGive(s_lock);
+            return ESP_OK;
+        }
+    }
+
+    if (s_count >= NOTIFY_OUTBOX_LEN) {
+        s_stats.dropped_full++;
+        xSemaphoreGive(s_lock);
+        ESP_LOGW(TAG, "发件箱已满，丢弃确认: %s", order_id);
+        return ESP_ERR_NO_MEM;
+    }
+
+    outbox_entry_t *entry = &s_entries[(s_head + s_count) % NOTIFY_OUTBOX_LEN];
+    snprintf(entry->order_id, sizeof(entry->order_id), "%s", order_id);
+    entry->station = station;
+    entry->posted_us = esp_timer_get_time();
+    s_count++;
+    s_stats.posted++;
+
+    xSemaphoreGive(s_lock);
+
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+}
+
+esp_err_t notify_outbox_post_completion(const char *order_id)
+{
+    return outbox_post(order_id, OUTBOX_WHOLE_ORDER);
+}
+
+esp_err_t notify_outbox_post_station(const char *order_id, uint8_t station)
+{
+    return outbox_post(order_id, station);
+}
+
+void notify_outbox_kick(void)
+{
+    if (s_task) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+void notify_outbox_get_stats(notify_outbox_stats_t *stats)
+{
+    if (!stats || !s_lock) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    stats->depth = s_count;
+    stats->latency_avg_ms = s_stats.acked ? (uint32_t)(s_latency_sum_ms / s_stats.acked) : 0;
+    xSemaphoreGive(s_lock);
+}
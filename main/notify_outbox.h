@@ -0,0 +1,72 @@
+/**
+ * @file notify_outbox.h
+ * @brief 出餐完成通知发件箱
+ *
+ * UI任务只把完成的订单ID放入有界队列，由发件任务合并、发送与重试：
+ * 多个确认在MTU允许时合并为一条 {"o":["id1","id2"],"s":true}，单个确认仍为 {"o":"id","s":true}；
+ * 工位子单出餐的确认为 {"o":"id","st":工位}，不参与合并，全部工位出餐后另发整单确认；
+ * 控制器拥塞（BLE_HS_ENOMEM）时按指数退避重试；
+ * 没有订阅的POS时确认保留一段时间，短暂断线重连后补发。
+ */
+
+#ifndef NOTIFY_OUTBOX_H
+#define NOTIFY_OUTBOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define NOTIFY_OUTBOX_LEN           32      // 待发送确认上限
+#define NOTIFY_OUTBOX_RETAIN_MS     30000   // 无订阅者时确认的保留时间
+#define NOTIFY_OUTBOX_MAX_RETRIES   8
+
+typedef struct {
+    uint32_t posted;            // 入队的确认数
+    uint32_t acked;             // 已送达的确认数
+    uint32_t notifications;     // 实际发出的通知条数（合并后）
+    uint32_t retries;           // 拥塞重试次数
+    uint32_t dropped_full;      // 队列满被丢弃
+    uint32_t dropped_expired;   // 保留超时被丢弃
+    uint32_t dropped_retry;     // 重试耗尽被丢弃
+    uint32_t depth;             // 当前排队数
+    uint32_t latency_avg_ms;    // 入队到送达的平均时延
+    uint32_t latency_max_ms;
+} notify_outbox_stats_t;
+
+/**
+ * @brief 创建发件队列与发件任务
+ */
+esp_err_t notify_outbox_init(void);
+
+/**
+ * @brief 投递一个出餐完成确认（任意任务，不阻塞）
+ *
+ * @return ESP_ERR_NO_MEM 队列已满，确认被丢弃
+ */
+esp_err_t notify_outbox_post_completion(const char *order_id);
+
+/**
+ * @brief 投递一个工位子单出餐确认（任意任务，不阻塞）
+ *
+ * @return ESP_ERR_NO_MEM 队列已满，确认被丢弃
+ */
+esp_err_t notify_outbox_post_station(const char *order_id, uint8_t station);
+
+/**
+ * @brief 唤醒发件任务（有新的订阅者时调用，补发保留的确认）
+ */
+void notify_outbox_kick(void);
+
+/**
+ * @brief 获取发件箱统计
+ */
+void notify_outbox_get_stats(notify_outbox_stats_t *stats);
+
+/**
+ * @brief 向单个连接发送一条通知（由 main.c 实现）
+ *
+ * @return 0 成功；否则为NimBLE错误码，BLE_HS_ENOMEM 表示可重试
+ */
+int send_notification(uint16_t conn_handle, const char *data, size_t len);
+
+#endif // NOTIFY_OUTBOX_H
@@ -0,0 +1,153 @@
+#include "order_dedup.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "OrderDedup";
+
+#define DEDUP_TABLE_SIZE    (ORDER_DEDUP_WINDOW * 2)    // 负载因子不超过0.5
+#define DEDUP_TABLE_MASK    (DEDUP_TABLE_SIZE - 1)
+
+_Static_assert((DEDUP_TABLE_SIZE & DEDUP_TABLE_MASK) == 0, "去重表大小必须为2的幂");
+
+// 开放寻址哈希表，tag 为0表示空槽；另用环形队列记录插入顺序，窗口满时淘汰最旧的条目。
+// 有序号的消息以消息键为 tag；无序号的消息以订单ID为 tag，val 保存该订单最近一条消息的内容键
+typedef struct {
+    uint64_t tag;
+    uint64_t val;
+} dedup_entry_t;
+
+static dedup_entry_t s_table[DEDUP_TABLE_SIZE];
+static uint64_t s_fifo[ORDER_DEDUP_WINDOW];
+static int s_fifo_head = 0;
+static int s_fifo_count = 0;
+static uint32_t s_hits = 0;
+
+#define FNV_OFFSET  0xcbf29ce484222325ULL
+#define FNV_PRIME   0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+// 无序号消息按订单ID索引，与消息键使用不同的起始值
+static uint64_t order_tag(const order_record_t *rec)
+{
+    uint64_t h = fnv1a(FNV_OFFSET, "id", 2);
+    h = fnv1a(h, rec->order_id, strlen(rec->order_id));
+    return h ? h : 1;
+}
+
+static uint64_t record_key(const order_record_t *rec)
+{
+    uint64_t h = fnv1a(FNV_OFFSET, rec->order_id, strlen(rec->order_id));
+
+    uint8_t op[2] = { (uint8_t)rec->type, (uint8_t)(rec->has_status ? 1 + rec->status : 0) };
+    h = fnv1a(h, op, sizeof(op));
+    if (rec->has_priority) {
+        h = fnv1a(h, &rec->priority, sizeof(rec->priority));
+        h = fnv1a(h, &rec->deadline, sizeof(rec->deadline));
+    }
+
+    if (rec->has_seq) {
+        h = fnv1a(h, &rec->seq, sizeof(rec->seq));
+    } else {
+        // 无序号时以菜品内容区分同一订单的不同编辑，只与该订单的上一条消息比较
+        for (int i = 0; i < rec->item_count; i++) {
+            h = fnv1a(h, order_record_item_name(rec, i), rec->items[i].name_len);
+            h = fnv1a(h, &rec->items[i].qty, sizeof(rec->items[i].qty));
+            h = fnv1a(h, &rec->items[i].station, sizeof(rec->items[i].station));
+            h = fnv1a(h, order_record_item_mods(rec, i), rec->items[i].mods_len);
+        }
+    }
+    return h ? h : 1;
+}
+
+static int table_find(uint64_t tag)
+{
+    for (int i = tag & DEDUP_TABLE_MASK; s_table[i].tag; i = (i + 1) & DEDUP_TABLE_MASK) {
+        if (s_table[i].tag == tag) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void table_insert(uint64_t tag, uint64_t val)
+{
+    int i = tag & DEDUP_TABLE_MASK;
+    while (s_table[i].tag) {
+        i = (i + 1) & DEDUP_TABLE_MASK;
+    }
+    s_table[i].tag = tag;
+    s_table[i].val = val;
+}
+
+// 线性探测的删除：把后续同一探测链上的键向前移动，不使用墓碑
+static void table_remove(uint64_t tag)
+{
+    int i = table_find(tag);
+    if (i < 0) return;
+
+    int j = i;
+    for (;;) {
+        j = (j + 1) & DEDUP_TABLE_MASK;
+        if (!s_table[j].tag) {
+            break;
+        }
+        int home = s_table[j].tag & DEDUP_TABLE_MASK;
+        // home 不在 (i, j] 区间内时，该键可以移到空出的 i
+        bool between = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!between) {
+            s_table[i] = s_table[j];
+            i = j;
+        }
+    }
+    s_table[i].tag = 0;
+}
+
+bool order_dedup_check(const order_record_t *rec)
+{
+    uint64_t key = record_key(rec);
+    uint64_t tag = rec->has_seq ? key : order_tag(rec);
+
+    int i = table_find(tag);
+    if (i >= 0) {
+        if (s_table[i].val == key) {
+            s_hits++;
+            ESP_LOGW(TAG, "丢弃重复消息: orderId=%s, type=%d%s", rec->order_id, rec->type,
+                     rec->has_seq ? "" : " (无序号)");
+            return true;
+        }
+        // 无序号且与该订单的上一条消息不同：合法的新消息（如改回之前的内容），只更新记住的内容键
+        s_table[i].val = key;
+        return false;
+    }
+
+    if (s_fifo_count == ORDER_DEDUP_WINDOW) {
+        table_remove(s_fifo[s_fifo_head]);
+        s_fifo_head = (s_fifo_head + 1) % ORDER_DEDUP_WINDOW;
+        s_fifo_count--;
+    }
+    s_fifo[(s_fifo_head + s_fifo_count) % ORDER_DEDUP_WINDOW] = tag;
+    s_fifo_count++;
+    table_insert(tag, key);
+    return false;
+}
+
+void order_dedup_reset(void)
+{
+    memset(s_table, 0, sizeof(s_table));
+    s_fifo_head = 0;
+    s_fifo_count = 0;
+}
+
+uint32_t order_dedup_hits(void)
+{
+    return s_hits;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file order_dedup.h
+ * @brief 订单消息去重窗口
+ *
+ * POS在写入确认丢失时会重传同一条消息。最近处理过的消息键
+ * (订单ID, 操作, 序号) 保存在固定大小的哈希集合中，重传的消息以O(1)代价被丢弃，
+ * 不会产生重复的订单卡片和多余的整屏重绘。没有序号的消息以菜品内容代替序号，
+ * 只有与同一订单的上一条消息完全相同时才视为重传，改回先前内容的更新（X→Y→X）照常应用。
+ * 仅在解析任务中调用，不加锁。
+ */
+
+#ifndef ORDER_DEDUP_H
+#define ORDER_DEDUP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "order_record.h"
+
+#define ORDER_DEDUP_WINDOW  128     // 记住的最近消息数量
+
+/**
+ * @brief 检查消息是否为重传，不是则记入窗口
+ *
+ * 有序号的消息在窗口内出现过即为重传；无序号的消息与同一订单的上一条消息相同才为重传。
+ *
+ * @return true 重复消息，应丢弃
+ */
+bool order_dedup_check(const order_record_t *rec);
+
+/**
+ * @brief 清空窗口（收到清空订单命令时调用，之后重新下发的订单不应被视为重复）
+ */
+void order_dedup_reset(void);
+
+/**
+ * @brief 累计丢弃的重复消息数
+ */
+uint32_t order_dedup_hits(void);
+
+#endif // ORDER_DEDUP_H
@@ -0,0 +1,26 @@
+#ifndef ORDER_EVENT_H
+#define ORDER_EVENT_H
+
+#include "order_record.h"
+
+// 解析任务交给UI任务的订单事件类型
+typedef enum {
+    ORDER_EVENT_ADD,        // 新订单
+    ORDER_EVENT_UPDATE,     // 订单编辑（整单替换菜品）
+    ORDER_EVENT_EDIT,       // 增量编辑（逐个菜品增删改数量）
+    ORDER_EVENT_COMPLETE,   // 出餐完成
+    ORDER_EVENT_REMOVE,     // 删除订单
+    ORDER_EVENT_CLEAR,      // 清空所有订单
+    ORDER_EVENT_MESSAGE,    // 系统消息弹窗
+    ORDER_EVENT_TIME,       // 时间同步
+    ORDER_EVENT_BATCH_BEGIN, // 批量操作开始，之后的事件合并为一次界面刷新
+    ORDER_EVENT_BATCH_END,   // 批量操作结束
+} order_event_type_t;
+
+typedef struct {
+    order_event_type_t type;
+    order_record_t *record; // 来自记录池，由UI任务处理后归还；CLEAR/TIME/BATCH_* 为NULL
+    long long timestamp;    // ORDER_EVENT_TIME 的毫秒时间戳
+} order_event_t;
+
+#endif // ORDER_EVENT_H
@@ -0,0 +1,195 @@
+#include "order_heap.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+
+static const char *TAG = "OrderHeap";
+
+#define CLASS_SIZE(c)       ((size_t)ORDER_HEAP_MIN_BLOCK << (c))
+#define CLASS_LARGE         UINT32_MAX      // 区域外的普通PSRAM分配
+
+// 块头紧挨在返回给调用方的指针之前
+typedef struct {
+    uint32_t size;          // 请求的字节数
+    uint32_t cls;           // 尺寸级别
+} block_hdr_t;
+
+_Static_assert(sizeof(block_hdr_t) == 8, "块头需保持8字节对齐");
+
+typedef struct free_block {
+    struct free_block *next;
+} free_block_t;
+
+static uint8_t *s_arena = NULL;
+static size_t s_arena_used = 0;
+static size_t s_arena_live = 0;     // 区域内的块中被请求使用的字节数
+static free_block_t *s_free[ORDER_HEAP_CLASSES];
+static order_heap_stats_t s_stats;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t size_class(size_t total)
+{
+    uint32_t c = 0;
+    while (c < ORDER_HEAP_CLASSES && CLASS_SIZE(c) < total) {
+        c++;
+    }
+    return c < ORDER_HEAP_CLASSES ? c : CLASS_LARGE;
+}
+
+static size_t block_bytes(const block_hdr_t *hdr)
+{
+    return hdr->cls == CLASS_LARGE ? hdr->size + sizeof(block_hdr_t) : CLASS_SIZE(hdr->cls);
+}
+
+// 以下两个函数在临界区内调用
+static void account_alloc(const block_hdr_t *hdr)
+{
+    s_stats.live_objects++;
+    s_stats.live_bytes += hdr->size;
+    s_stats.block_bytes += block_bytes(hdr);
+    if (s_stats.live_bytes > s_stats.peak_bytes) {
+        s_stats.peak_bytes = s_stats.live_bytes;
+    }
+    if (hdr->cls == CLASS_LARGE) {
+        s_stats.fallback_objects++;
+    } else {
+        s_arena_live += hdr->size;
+    }
+}
+
+static void account_free(const block_hdr_t *hdr)
+{
+    s_stats.live_objects--;
+    s_stats.live_bytes -= hdr->size;
+    s_stats.block_bytes -= block_bytes(hdr);
+    if (hdr->cls == CLASS_LARGE) {
+        s_stats.fallback_objects--;
+    } else {
+        s_arena_live -= hdr->size;
+    }
+}
+
+esp_err_t order_heap_init(void)
+{
+    if (s_arena) {
+        return ESP_OK;
+    }
+
+    s_arena = heap_caps_malloc(ORDER_HEAP_ARENA_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_arena) {
+        ESP_LOGE(TAG, "订单堆区域分配失败");
+        return ESP_ERR_NO_MEM;
+    }
+    s_stats.arena_size = ORDER_HEAP_ARENA_SIZE;
+
+    ESP_LOGI(TAG, "订单堆: %d KB PSRAM, %d 个尺寸级别", ORDER_HEAP_ARENA_SIZE / 1024, ORDER_HEAP_CLASSES);
+    return ESP_OK;
+}
+
+void *order_heap_alloc(size_t size)
+{
+    if (size == 0 || size > UINT32_MAX - sizeof(block_hdr_t)) {
+        return NULL;
+    }
+
+    size_t total = size + sizeof(block_hdr_t);
+    uint32_t cls = size_class(total);
+    block_hdr_t *hdr = NULL;
+
+    if (cls != CLASS_LARGE && s_arena) {
+        taskENTER_CRITICAL(&s_mux);
+        if (s_free[cls]) {
+            hdr = (block_hdr_t *)s_free[cls];
+            s_free[cls] = s_free[cls]->next;
+            s_stats.free_bytes -= CLASS_SIZE(cls);
+        } else if (s_arena_used + CLASS_SIZE(cls) <= ORDER_HEAP_ARENA_SIZE) {
+            hdr = (block_hdr_t *)(s_arena + s_arena_used);
+            s_arena_used += CLASS_SIZE(cls);
+            s_stats.arena_used = s_arena_used;
+        }
+        taskEXIT_CRITICAL(&s_mux);
+    }
+
+    if (!hdr) {
+        hdr = heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!hdr) {
+            taskENTER_CRITICAL(&s_mux);
+            s_stats.failures++;
+            taskEXIT_CRITICAL(&s_mux);
+            return NULL;
+        }
+        cls = CLASS_LARGE;
+    }
+
+    hdr->size = size;
+    hdr->cls = cls;
+    taskENTER_CRITICAL(&s_mux);
+    account_alloc(hdr);
+    taskEXIT_CRITICAL(&s_mux);
+    return hdr + 1;
+}
+
+void *order_heap_realloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return order_heap_alloc(size);
+    }
+    if (size == 0) {
+        order_heap_free(ptr);
+        return NULL;
+    }
+
+    block_hdr_t *hdr = (block_hdr_t *)ptr - 1;
+    if (hdr->cls != CLASS_LARGE && size + sizeof(block_hdr_t) <= CLASS_SIZE(hdr->cls)) {
+        taskENTER_CRITICAL(&s_mux);
+        account_free(hdr);
+        hdr->size = size;
+        account_alloc(hdr);
+        taskEXIT_CRITICAL(&s_mux);
+        return ptr;
+    }
+
+    void *p = order_heap_alloc(size);
+    if (!p) {
+        return NULL;
+    }
+    memcpy(p, ptr, hdr->size < size ? hdr->size : size);
+    order_heap_free(ptr);
+    return p;
+}
+
+void order_heap_free(void *ptr)
+{
+    if (!ptr) return;
+
+    block_hdr_t *hdr = (block_hdr_t *)ptr - 1;
+    uint32_t cls = hdr->cls;
+
+    taskENTER_CRITICAL(&s_mux);
+    account_free(hdr);
+    if (cls != CLASS_LARGE) {
+        free_block_t *blk = (free_block_t *)hdr;
+        blk->next = s_free[cls];
+        s_free[cls] = blk;
+        s_stats.free_bytes += CLASS_SIZE(cls);
+    }
+    taskEXIT_CRITICAL(&s_mux);
+
+    if (cls == CLASS_LARGE) {
+        heap_caps_free(hdr);
+    }
+}
+
+void order_heap_get_stats(order_heap_stats_t *stats)
+{
+    if (!stats) return;
+
+    taskENTER_CRITICAL(&s_mux);
+    *stats = s_stats;
+    size_t live = s_arena_live;
+    taskEXIT_CRITICAL(&s_mux);
+
+    stats->fragmentation_pct = stats->arena_used ?
+        (uint32_t)((uint64_t)(stats->arena_used - live) * 100 / stats->arena_used) : 0;
+}
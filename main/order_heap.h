@@ -0,0 +1,61 @@
+/**
+ * @file order_heap.h
+ * @brief 订单数据专用堆（PSRAM）
+ *
+ * 订单的菜品数组与文本区从一块独立的PSRAM区域分配，不再与LVGL共用内部RAM堆，
+ * 长时间营业时不会在LVGL对象之间留下碎片。
+ * 区域按顺序切分（bump）为2的幂尺寸级别的块，释放的块进入该级别的空闲链表，
+ * 之后同级别的分配直接复用；块不拆分也不合并。区域用尽时退回普通PSRAM分配。
+ * 订单记录本身由 order_store 的固定大小池分配。
+ */
+
+#ifndef ORDER_HEAP_H
+#define ORDER_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ORDER_HEAP_ARENA_SIZE   (4 * 1024 * 1024)
+#define ORDER_HEAP_MIN_BLOCK    16          // 最小块（含块头）
+#define ORDER_HEAP_CLASSES      14          // 16B ~ 128KB
+
+typedef struct {
+    uint32_t live_objects;      // 当前分配的块数
+    uint32_t live_bytes;        // 当前请求的字节数
+    uint32_t peak_bytes;        // live_bytes 的峰值
+    uint32_t block_bytes;       // 当前分配的块占用字节数（含块头与尺寸取整）
+    uint32_t free_bytes;        // 空闲链表中的块字节数
+    uint32_t arena_used;        // 已从区域切出的字节数
+    uint32_t arena_size;
+    uint32_t fallback_objects;  // 区域用尽后退回普通PSRAM分配的块数
+    uint32_t failures;          // 分配失败次数
+    uint32_t fragmentation_pct; // 已切出但未被请求使用的比例（取整与空闲块）
+} order_heap_stats_t;
+
+/**
+ * @brief 分配区域（PSRAM）
+ */
+esp_err_t order_heap_init(void);
+
+/**
+ * @brief 分配，失败返回NULL；未初始化时退回普通PSRAM分配
+ */
+void *order_heap_alloc(size_t size);
+
+/**
+ * @brief 调整大小，语义同 realloc（ptr 可为NULL）；同一尺寸级别内就地完成
+ */
+void *order_heap_realloc(void *ptr, size_t size);
+
+/**
+ * @brief 释放（ptr 可为NULL）
+ */
+void order_heap_free(void *ptr);
+
+/**
+ * @brief 获取统计（任意任务）
+ */
+void order_heap_get_stats(order_heap_stats_t *stats);
+
+#endif // ORDER_HEAP_H
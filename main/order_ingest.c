@@ -0,0 +1,484 @@
+#include "order_ingest.h"
+#include "order_event.h"
+#include "order_parser.h"
+#include "order_tlv.h"
+#include "order_reasm.h"
+#include "order_dedup.h"
+#include "menu_catalog.h"
+#include "order_station.h"
+#include "order_ui.h"
+#include "spsc_ring.h"
+#include "hex_utils.h"
+#include "utf8_validator.h"
+#include "time_sync.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "host/ble_hs.h"
+#include <stdio.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const char *TAG = "OrderIngest";
+
+#define INGEST_TASK_STACK_SIZE  6144
+#define INGEST_TASK_PRIORITY    5
+
+// 环形缓冲区中的一帧，len 为0表示连接断开的控制帧
+typedef struct {
+    uint16_t len;
+    uint16_t conn_handle;
+    uint8_t encoding;       // order_encoding_t
+    uint8_t data[ORDER_INGEST_FRAME_MAX + 1];  // 额外1字节用于结束符
+} ingest_frame_t;
+
+static spsc_ring_t s_ring;
+static TaskHandle_t s_ingest_task = NULL;
+static uint32_t s_received = 0;       // 仅生产者写
+static uint32_t s_parse_errors = 0;   // 仅解析任务写
+static uint32_t s_parsed = 0;         // 以下解码计时仅解析任务写
+static uint32_t s_parse_us_total = 0;
+static uint32_t s_parse_us_max = 0;
+
+// 投递事件到UI任务，失败时归还事件持有的记录
+static void post_event(order_event_t *evt)
+{
+    if (!order_ui_post_event(evt)) {
+        ESP_LOGE(TAG, "投递订单事件失败: type=%d", evt->type);
+        order_record_release(evt->record);
+    }
+}
+
+// 处理系统消息，记录的所有权转移给事件或在此归还
+static void handle_system_message(order_record_t *rec)
+{
+    // 处理clean命令 - 清空所有订单
+    if (strcmp(rec->command, "clean") == 0) {
+        ESP_LOGI(TAG, "收到清空订单命令");
+        order_dedup_reset();
+        order_record_release(rec);
+        order_event_t evt = { .type = ORDER_EVENT_CLEAR };
+        post_event(&evt);
+        return;
+    }
+
+    // 工位映射：content 为 "分类:工位,..."
+    if (strcmp(rec->command, ORDER_STATION_MAP_CMD) == 0) {
+        const char *spec = order_record_content(rec);
+        if (!spec || order_station_set_map(spec) != ESP_OK) {
+            ESP_LOGE(TAG, "工位映射无效: %s", spec ? spec : "");
+            s_parse_errors++;
+        }
+        order_record_release(rec);
+        return;
+    }
+
+    // 处理display_test命令的时间戳同步
+    if (strcmp(rec->command, "display_test") == 0) {
+        long long ts = rec->timestamp;
+        if (rec->timestamp_text[0]) {
+            // 新格式：字符串时间戳 "9/28/2025, 6:00:26 PM"
+            ts = parse_timestamp_string(rec->timestamp_text);
+        }
+
+        if (ts > 0) {
+            ESP_LOGI(TAG, "收到时间戳: %lld", ts);
+
+            // 保存时间到NVS
+            save_time_to_nvs(ts);
+
+            // 更新时间显示
+            order_event_t evt = { .type = ORDER_EVENT_TIME, .timestamp = ts };
+            post_event(&evt);
+        }
+    }
+
+    if (!rec->has_content) {
+        order_record_release(rec);
+        return;
+    }
+
+    ESP_LOGI(TAG, "系统消息: %s", order_record_content(rec));
+    order_event_t evt = { .type = ORDER_EVENT_MESSAGE, .record = rec };
+    post_event(&evt);
+}
+
+// 处理订单消息（add/update/remove/edit），记录随事件交给UI任务
+static void handle_order_message(order_record_t *rec)
+{
+    if (rec->order_id[0] == '\0') {
+        ESP_LOGE(TAG, "无效的订单ID");
+        order_record_release(rec);
+        return;
+    }
+
+    // POS重传（写入确认丢失）的消息直接丢弃
+    if (order_dedup_check(rec)) {
+        order_record_release(rec);
+        return;
+    }
+
+    ESP_LOGI(TAG, "处理订单: type=%d, orderId=%s, 菜品%d个", rec->type, rec->order_id, rec->item_count);
+
+    // 菜品的工位在此确定一次，UI与订单存储按工位拆分子单
+    order_station_resolve(rec);
+
+    order_event_t evt = { .record = rec };
+    switch (rec->type) {
+    case ORDER_MSG_ADD:
+        evt.type = ORDER_EVENT_ADD;
+        break;
+    case ORDER_MSG_REMOVE:
+        evt.type = ORDER_EVENT_REMOVE;
+        break;
+    case ORDER_MSG_EDIT:
+        evt.type = ORDER_EVENT_EDIT;
+        break;
+    default:
+        // status: true - 出餐完成；false 或缺失 - 订单编辑
+        evt.type = (rec->has_status && rec->status) ? ORDER_EVENT_COMPLETE : ORDER_EVENT_UPDATE;
+        break;
+    }
+    post_event(&evt);
+}
+
+// 菜单同步分段写入目录，记录在此归还
+static void handle_menu_message(order_record_t *rec)
+{
+    ESP_LOGI(TAG, "菜单同步: 版本 %u, 段 %d/%d, %d 项", (unsigned)rec->menu_version,
+             rec->menu_part + 1, rec->menu_parts ? rec->menu_parts : 1, rec->item_count);
+
+    esp_err_t err = menu_catalog_apply(rec);
+    if (err != ESP_OK && err != ESP_ERR_NOT_FINISHED) {
+        ESP_LOGE(TAG, "菜单同步失败: %s", esp_err_to_name(err));
+        s_parse_errors++;
+    }
+    order_record_release(rec);
+}
+
+// 批量中的单条操作：取新记录解码后按普通订单消息处理
+typedef struct {
+    int applied;
+    int failed;
+} batch_ctx_t;
+
+static void dispatch_batch_op(order_record_t *rec, esp_err_t err, batch_ctx_t *ctx)
+{
+    if (err != ESP_OK || rec->type == ORDER_MSG_INFO || rec->type == ORDER_MSG_BATCH ||
+        rec->type == ORDER_MSG_MENU) {
+        ctx->failed++;
+        order_record_release(rec);
+        return;
+    }
+    ctx->applied++;
+    handle_order_message(rec);
+}
+
+static void json_batch_op_cb(const char *op, size_t op_len, void *arg)
+{
+    order_record_t *rec = order_record_acquire(ORDER_RECORD_WAIT_FOREVER);
+    if (!rec) return;
+    dispatch_batch_op(rec, order_parser_parse(op, op_len, rec), arg);
+}
+
+static void tlv_batch_op_cb(const uint8_t *op, size_t op_len, void *arg)
+{
+    order_record_t *rec = order_record_acquire(ORDER_RECORD_WAIT_FOREVER);
+    if (!rec) return;
+    dispatch_batch_op(rec, order_tlv_decode_op(op, op_len, rec), arg);
+}
+
+// 批量消息：首尾投递边界事件，UI任务连续应用已到达的操作，只在发送方停顿时与结束时刷新界面
+static void handle_batch_message(uint8_t *data, size_t len, uint8_t encoding, order_record_t *batch)
+{
+    batch_ctx_t ctx = { 0 };
+    esp_err_t err;
+
+    order_event_t begin = { .type = ORDER_EVENT_BATCH_BEGIN };
+    post_event(&begin);
+
+    if (encoding == ORDER_ENCODING_TLV) {
+        err = order_tlv_for_each_op(data, len, tlv_batch_op_cb, &ctx);
+    } else {
+        err = order_parser_for_each_op((const char *)data + batch->batch_off,
+                                       batch->batch_len, json_batch_op_cb, &ctx);
+    }
+    order_record_release(batch);
+
+    order_event_t end = { .type = ORDER_EVENT_BATCH_END };
+    post_event(&end);
+
+    if (err != ESP_OK || ctx.failed > 0) {
+        s_parse_errors++;
+    }
+    ESP_LOGI(TAG, "批量消息: 应用 %d 条, 失败 %d 条", ctx.applied, ctx.failed);
+}
+
+// 非标准JSON时尝试提取content字段作为弹窗消息
+static void handle_malformed_frame(char *buf, order_record_t *rec)
+{
+    char *content_start = strstr(buf, "content");
+    char *quote_start = content_start ? strchr(content_start, '"') : NULL;
+    char *quote_end = quote_start ? strchr(quote_start + 1, '"') : NULL;
+    if (!quote_end) {
+        order_record_release(rec);
+        return;
+    }
+
+    const char *hex_content = quote_start + 1;
+    size_t hex_len = quote_end - hex_content;
+    int decoded = hex_decode(hex_content, hex_len, (uint8_t *)rec->text, sizeof(rec->text) - 1);
+    if (decoded <= 0) {
+        order_record_release(rec);
+        return;
+    }
+
+    order_record_reset(rec);
+    rec->type = ORDER_MSG_INFO;
+    rec->has_content = true;
+    rec->content_len = decoded;
+    rec->text[decoded] = '\0';
+    rec->text_len = rec->content_len + 1;
+    ESP_LOGW(TAG, "解码内容: %s", rec->text);
+
+    order_event_t evt = { .type = ORDER_EVENT_MESSAGE, .record = rec };
+    post_event(&evt);
+}
+
+// 解析一条完整消息，data 后至少预留1字节用于结束符
+static void handle_message(uint8_t *data, size_t len, uint16_t conn_handle, uint8_t encoding)
+{
+    char *buf = (char *)data;
+    buf[len] = '\0';
+
+    // 记录池耗尽说明UI任务积压，阻塞解析任务，由环形缓冲区吸收突发
+    order_record_t *rec = order_record_acquire(ORDER_RECORD_WAIT_FOREVER);
+    if (!rec) {
+        return;
+    }
+
+    esp_err_t err;
+    int64_t t0;
+    if (encoding == ORDER_ENCODING_TLV) {
+        ESP_LOGI(TAG, "收到蓝牙TLV信息，长度: %d, conn=%d", (int)len, conn_handle);
+        t0 = esp_timer_get_time();
+        err = order_tlv_decode(data, len, rec);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "TLV解码失败: %s", esp_err_to_name(err));
+            s_parse_errors++;
+            order_record_release(rec);
+            return;
+        }
+    } else {
+        ESP_LOGI(TAG, "收到蓝牙JSON信息，长度: %d, conn=%d", (int)len, conn_handle);
+        ESP_LOGD(TAG, "原始JSON数据: %.*s", (int)len, buf);
+        t0 = esp_timer_get_time();
+
+        // 整帧一次校验，非法的UTF-8不进入解析器和LVGL字形查找
+        if (!utf8_is_valid(data, len)) {
+            ESP_LOGE(TAG, "帧不是有效的UTF-8，已丢弃");
+            s_parse_errors++;
+            order_record_release(rec);
+            return;
+        }
+
+        err = order_parser_parse(buf, len, rec);
+        if (err != ESP_OK) {
+            s_parse_errors++;
+            if (err == ESP_ERR_INVALID_ARG) {
+                ESP_LOGE(TAG, "JSON解析失败");
+                handle_malformed_frame(buf, rec);
+            } else {
+                order_record_release(rec);
+            }
+            return;
+        }
+    }
+
+    // 计时只含UTF-8校验与解码，不含日志输出与其后的事件投递
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    s_parsed++;
+    s_parse_us_total += us;
+    if (us > s_parse_us_max) {
+        s_parse_us_max = us;
+    }
+
+    if (rec->type == ORDER_MSG_INFO) {
+        handle_system_message(rec);
+    } else if (rec->type == ORDER_MSG_BATCH) {
+        handle_batch_message(data, len, encoding, rec);
+    } else if (rec->type == ORDER_MSG_MENU) {
+        handle_menu_message(rec);
+    } else {
+        handle_order_message(rec);
+    }
+}
+
+static void handle_frame(ingest_frame_t *frame)
+{
+    if (frame->len == 0) {
+        order_reasm_drop_conn(frame->conn_handle);
+        return;
+    }
+
+    if (!order_reasm_is_fragment(frame->data, frame->len)) {
+        handle_message(frame->data, frame->len, frame->conn_handle, frame->encoding);
+        return;
+    }
+
+    order_reasm_msg_t msg;
+    esp_err_t err = order_reasm_feed(frame->conn_handle, frame->encoding, frame->data, frame->len, &msg);
+    if (err == ESP_ERR_NOT_FINISHED) {
+        return;
+    }
+    if (err != ESP_OK) {
+        s_parse_errors++;
+        return;
+    }
+
+    ESP_LOGI(TAG, "分片重组完成: %d 字节", (int)msg.len);
+    handle_message(msg.data, msg.len, msg.conn_handle, msg.encoding);
+    order_reasm_release(&msg);
+}
+
+// 解析任务：排空环形缓冲区，逐帧解析
+static void order_ingest_task(void *arg)
+{
+    uint32_t reported_dropped = 0;
+    uint32_t pending_reasm = 0;
+
+    for (;;) {
+        // 有未完成的分片重组时定期醒来淘汰超时的缓冲区
+        ulTaskNotifyTake(pdTRUE, pending_reasm ? pdMS_TO_TICKS(ORDER_REASM_TIMEOUT_MS) : portMAX_DELAY);
+
+        ingest_frame_t *frame;
+        while ((frame = spsc_ring_peek(&s_ring)) != NULL) {
+            handle_frame(frame);
+            spsc_ring_pop(&s_ring);
+        }
+        pending_reasm = order_reasm_evict_expired();
+
+        uint32_t dropped = atomic_load_explicit(&s_ring.dropped, memory_order_relaxed);
+        if (dropped != reported_dropped) {
+            ESP_LOGW(TAG, "接收缓冲区已满，累计丢弃 %lu 帧 (高水位 %lu/%d)",
+                     (unsigned long)dropped,
+                     (unsigned long)atomic_load_explicit(&s_ring.high_water, memory_order_relaxed),
+                     ORDER_INGEST_SLOTS);
+            reported_dropped = dropped;
+        }
+    }
+}
+
+esp_err_t order_ingest_init(void)
+{
+    if (s_ingest_task) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = order_record_pool_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = order_reasm_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // 目录不可用时仍可按菜名下单
+    if (menu_catalog_init() != ESP_OK) {
+        ESP_LOGW(TAG, "菜品目录初始化失败，仅支持按菜名下单");
+    }
+    order_station_init();
+
+    void *storage = heap_caps_calloc(ORDER_INGEST_SLOTS, sizeof(ingest_frame_t),
+                                     MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!storage) {
+        ESP_LOGE(TAG, "接收缓冲区分配失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    spsc_ring_init(&s_ring, storage, sizeof(ingest_frame_t), ORDER_INGEST_SLOTS);
+
+    if (xTaskCreate(order_ingest_task, "order_ingest", INGEST_TASK_STACK_SIZE,
+                    NULL, INGEST_TASK_PRIORITY, &s_ingest_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建解析任务失败");
+        heap_caps_free(storage);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "订单接收阶段已启动: %d 槽位 x %d 字节", ORDER_INGEST_SLOTS, ORDER_INGEST_FRAME_MAX);
+    return ESP_OK;
+}
+
+esp_err_t order_ingest_submit(uint16_t conn_handle, order_encoding_t encoding, struct os_mbuf *om)
+{
+    uint16_t len = OS_MBUF_PKTLEN(om);
+    if (len == 0 || len > ORDER_INGEST_FRAME_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ingest_frame_t *frame = spsc_ring_acquire(&s_ring);
+    if (!frame) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (os_mbuf_copydata(om, 0, len, frame->data) != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    frame->len = len;
+    frame->conn_handle = conn_handle;
+    frame->encoding = encoding;
+
+    spsc_ring_push(&s_ring);
+    s_received++;
+    xTaskNotifyGive(s_ingest_task);
+    return ESP_OK;
+}
+
+void order_ingest_conn_closed(uint16_t conn_handle)
+{
+    ingest_frame_t *frame = spsc_ring_acquire(&s_ring);
+    if (!frame) {
+        // 缓冲区满时由重组超时兜底释放
+        return;
+    }
+
+    frame->len = 0;
+    frame->conn_handle = conn_handle;
+    spsc_ring_push(&s_ring);
+    xTaskNotifyGive(s_ingest_task);
+}
+
+const char *order_ingest_capabilities(void)
+{
+    // JSON 为兜底编码，TLV 附带版本号
+    // frag 为分片重组后的消息上限，menu 为当前菜品目录版本（0 表示需要同步）
+    // 只在NimBLE主机任务的读回调中调用，静态缓冲区无需加锁
+    static char caps[96];
+    snprintf(caps, sizeof(caps),
+             "{\"enc\":[\"json\",\"tlv\"],\"tlv\":" ORDER_TLV_VERSION_STR ",\"frag\":" ORDER_REASM_MSG_MAX_STR
+             ",\"menu\":%u}", (unsigned)menu_catalog_version());
+    return caps;
+}
+
+void order_ingest_get_stats(order_ingest_stats_t *stats)
+{
+    if (!stats) return;
+
+    stats->depth = spsc_ring_depth(&s_ring);
+    stats->high_water = atomic_load_explicit(&s_ring.high_water, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&s_ring.dropped, memory_order_relaxed);
+    stats->received = s_received;
+    stats->parse_errors = s_parse_errors;
+    stats->duplicates = order_dedup_hits();
+    stats->parsed = s_parsed;
+    stats->parse_us_avg = s_parsed ? s_parse_us_total / s_parsed : 0;
+    stats->parse_us_max = s_parse_us_max;
+
+    order_reasm_stats_t reasm;
+    order_reasm_get_stats(&reasm);
+    stats->reassembled = reasm.completed;
+    stats->reasm_evicted = reasm.evicted;
+}
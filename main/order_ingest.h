@@ -0,0 +1,65 @@
+#ifndef ORDER_INGEST_H
+#define ORDER_INGEST_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+struct os_mbuf;
+
+#define ORDER_INGEST_FRAME_MAX  1024  // 单次写入最大字节数，更大的消息使用分片（见 order_reasm.h）
+#define ORDER_INGEST_SLOTS      16    // 环形缓冲区槽位数（2的幂）
+
+// 帧编码，由写入的特征决定
+typedef enum {
+    ORDER_ENCODING_JSON = 0,    // 0x1234，JSON（菜品名十六进制编码）
+    ORDER_ENCODING_TLV,         // 0x1235，二进制TLV（原始UTF-8）
+} order_encoding_t;
+
+// 接收阶段统计
+typedef struct {
+    uint32_t depth;         // 当前排队帧数
+    uint32_t high_water;    // 历史最大排队帧数
+    uint32_t dropped;       // 缓冲区满时丢弃的帧数
+    uint32_t received;      // 成功入队的帧数
+    uint32_t parse_errors;  // 解析失败的帧数
+    uint32_t duplicates;    // 去重窗口丢弃的重传消息数
+    uint32_t reassembled;   // 分片重组完成的消息数
+    uint32_t reasm_evicted; // 超时淘汰的未完成重组数
+    uint32_t parsed;        // 解析成功的帧数（校验+解码计时的样本数）
+    uint32_t parse_us_avg;  // 每帧UTF-8校验与解码的平均耗时（微秒）
+    uint32_t parse_us_max;  // 最大耗时（微秒）
+} order_ingest_stats_t;
+
+/**
+ * @brief 初始化接收环形缓冲区并启动解析任务
+ */
+esp_err_t order_ingest_init(void);
+
+/**
+ * @brief 将一次GATT写入复制进环形缓冲区（在NimBLE主机任务中调用，立即返回）
+ *
+ * @param conn_handle 连接句柄
+ * @param encoding 帧编码
+ * @param om 写入数据
+ * @return ESP_OK 已入队
+ * @return ESP_ERR_INVALID_SIZE 数据长度无效
+ * @return ESP_ERR_NO_MEM 缓冲区已满，帧被丢弃
+ */
+esp_err_t order_ingest_submit(uint16_t conn_handle, order_encoding_t encoding, struct os_mbuf *om);
+
+/**
+ * @brief 通知解析任务某个连接已断开，释放其未完成的分片重组（在NimBLE主机任务中调用）
+ */
+void order_ingest_conn_closed(uint16_t conn_handle);
+
+/**
+ * @brief 支持的编码能力与菜品目录版本（JSON字符串），供POS在读取 0x1234 时协商
+ */
+const char *order_ingest_capabilities(void);
+
+/**
+ * @brief 获取接收阶段统计
+ */
+void order_ingest_get_stats(order_ingest_stats_t *stats);
+
+#endif // ORDER_INGEST_H
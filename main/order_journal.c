@@ -0,0 +1,594 @@
+#include "order_journal.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "bsp/esp-bsp.h"
+#include <stddef.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+static const char *TAG = "OrderJournal";
+
+#define JOURNAL_MAGIC           0x324A524FU     // "ORJ2"，记录格式变化时递增，旧格式的段视为空
+#define JOURNAL_TASK_STACK_SIZE 4096
+#define JOURNAL_TASK_PRIORITY   2               // 低于UI任务
+#define JOURNAL_SNAPSHOT_SIZE   (ORDER_JOURNAL_REGION_SIZE / 2)
+
+// 段布局: [段头][记录]...，未写入的部分保持擦除状态(0xFF)
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;           // 段序号，从1递增，物理位置为 seq % ORDER_JOURNAL_SEGMENTS
+    uint32_t crc;           // magic 与 seq 的CRC32
+    uint32_t reserved;
+} segment_header_t;
+
+typedef struct {
+    uint16_t len;           // 负载字节数，0xFFFF 表示擦除状态（段内记录结束）
+    uint8_t type;
+    uint8_t reserved;
+    uint32_t crc;           // type 与负载的CRC32
+} record_header_t;
+
+typedef enum {
+    REC_UPSERT = 1,         // [ID长度 u8][ID][订单号 u32][优先级 u8][期限 u32][已出餐工位 u8][菜品数 u16]
+                            // {[菜名长度 u16][备注长度 u16][数量 u16][工位 u8][菜名][备注]}...
+    REC_REMOVE,             // [ID长度 u8][ID]
+    REC_CLEAR,
+    REC_CKPT_BEGIN,         // 检查点：之后到 REC_CKPT_END 为全部订单的快照
+    REC_CKPT_END,
+} record_type_t;
+
+#define RECORD_PAYLOAD_MAX  (ORDER_JOURNAL_SEGMENT_SIZE - sizeof(segment_header_t) - sizeof(record_header_t))
+
+_Static_assert(sizeof(segment_header_t) == 16 && sizeof(record_header_t) == 8, "日志头部大小不符");
+_Static_assert(RECORD_PAYLOAD_MAX < 0xFFFF, "记录长度以 uint16_t 保存");
+_Static_assert(ORDER_JOURNAL_BUFFER_SIZE >= ORDER_JOURNAL_SEGMENT_SIZE, "缓冲区须能容纳最大记录");
+
+static const esp_partition_t *s_part = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+
+// 由 s_lock 保护：UI写入，日志任务取走
+static uint8_t *s_buf = NULL;
+static size_t s_buf_len = 0;
+static bool s_resync = false;       // 缓冲区满丢弃过记录，下次写入检查点使flash与内存一致
+
+// 以下只在日志任务中访问（初始化完成后）
+static uint8_t *s_flush = NULL;
+static uint8_t *s_snapshot = NULL;
+static uint32_t s_head_seq = 0;     // 当前写入段，0 表示尚无
+static size_t s_head_off = 0;       // 当前段内写入偏移
+static uint32_t s_ckpt_seq = 1;     // 回放起点所在段，更早的段可被覆盖
+
+static size_t segment_offset(uint32_t seq)
+{
+    return ORDER_JOURNAL_REGION_OFFSET + (size_t)(seq % ORDER_JOURNAL_SEGMENTS) * ORDER_JOURNAL_SEGMENT_SIZE;
+}
+
+static size_t record_total(size_t payload_len)
+{
+    return sizeof(record_header_t) + ((payload_len + 3) & ~(size_t)3);
+}
+
+static uint32_t record_crc(uint8_t type, const uint8_t *payload, size_t len)
+{
+    return esp_rom_crc32_le(esp_rom_crc32_le(0, &type, 1), payload, len);
+}
+
+static uint32_t segment_crc(const segment_header_t *hdr)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)hdr, offsetof(segment_header_t, crc));
+}
+
+// ---------- 编码 ----------
+
+static size_t payload_size(uint8_t type, const order_info_t *order, const char *order_id)
+{
+    switch (type) {
+    case REC_UPSERT: {
+        size_t n = 1 + strlen(order->order_id) + 4 + 1 + 4 + 1 + 2;
+        for (int i = 0; i < order->item_count; i++) {
+            n += 7 + order->items[i].name_len + order->items[i].mods_len;
+        }
+        return n;
+    }
+    case REC_REMOVE:
+        return 1 + strlen(order_id);
+    default:
+        return 0;
+    }
+}
+
+static uint8_t *put(uint8_t *p, const void *v, size_t n)
+{
+    memcpy(p, v, n);
+    return p + n;
+}
+
+// 编码一条记录，返回写入的字节数；容量不足或记录超过单段上限时返回0
+static size_t encode_record(uint8_t *dst, size_t cap, uint8_t type, const order_info_t *order, const char *order_id)
+{
+    size_t len = payload_size(type, order, order_id);
+    size_t total = record_total(len);
+    if (len > RECORD_PAYLOAD_MAX || total > cap) {
+        return 0;
+    }
+
+    uint8_t *payload = dst + sizeof(record_header_t);
+    uint8_t *p = payload;
+    if (type == REC_UPSERT) {
+        uint8_t id_len = strlen(order->order_id);
+        uint32_t num = order->order_num;
+        p = put(p, &id_len, 1);
+        p = put(p, order->order_id, id_len);
+        p = put(p, &num, 4);
+        p = put(p, &order->priority, 1);
+        p = put(p, &order->deadline, 4);
+        p = put(p, &order->done, 1);
+        p = put(p, &order->item_count, 2);
+        for (int i = 0; i < order->item_count; i++) {
+            const order_dish_t *dish = &order->items[i];
+            p = put(p, &dish->name_len, 2);
+            p = put(p, &dish->mods_len, 2);
+            p = put(p, &dish->qty, 2);
+            p = put(p, &dish->station, 1);
+            p = put(p, order->text + dish->name_off, dish->name_len);
+            if (dish->mods_len) {
+                p = put(p, order->text + dish->mods_off, dish->mods_len);
+            }
+        }
+    } else if (type == REC_REMOVE) {
+        uint8_t id_len = strlen(order_id);
+        p = put(p, &id_len, 1);
+        p = put(p, order_id, id_len);
+    }
+    memset(p, 0xFF, total - sizeof(record_header_t) - len);
+
+    record_header_t hdr = {
+        .len = len,
+        .type = type,
+        .reserved = 0xFF,
+        .crc = record_crc(type, payload, len),
+    };
+    memcpy(dst, &hdr, sizeof(hdr));
+    return total;
+}
+
+// UI侧：记录写入内存缓冲区，过半时唤醒日志任务
+static void journal_append(uint8_t type, const order_info_t *order, const char *order_id)
+{
+    if (!s_lock) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    size_t n = encode_record(s_buf + s_buf_len, ORDER_JOURNAL_BUFFER_SIZE - s_buf_len, type, order, order_id);
+    if (n == 0) {
+        // 丢弃的记录由下一次检查点补齐
+        s_resync = true;
+    }
+    s_buf_len += n;
+    bool wake = n == 0 || s_buf_len >= ORDER_JOURNAL_BUFFER_SIZE / 2;
+    xSemaphoreGive(s_lock);
+
+    if (n == 0) {
+        ESP_LOGW(TAG, "日志缓冲区已满或记录过大 (类型 %d)，将写入检查点", type);
+    }
+    if (wake && s_task) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+void order_journal_upsert(const order_info_t *order)
+{
+    journal_append(REC_UPSERT, order, NULL);
+}
+
+void order_journal_remove(const char *order_id)
+{
+    journal_append(REC_REMOVE, NULL, order_id);
+}
+
+void order_journal_clear(void)
+{
+    journal_append(REC_CLEAR, NULL, NULL);
+}
+
+// ---------- 写入 ----------
+
+static esp_err_t open_segment(void)
+{
+    uint32_t seq = s_head_seq + 1;
+    // 循环覆盖的是 seq - SEGMENTS 段，它仍在回放范围内时日志已满
+    if (seq > ORDER_JOURNAL_SEGMENTS && seq - ORDER_JOURNAL_SEGMENTS >= s_ckpt_seq) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    segment_header_t hdr = { .magic = JOURNAL_MAGIC, .seq = seq, .reserved = 0xFFFFFFFF };
+    hdr.crc = segment_crc(&hdr);
+
+    size_t off = segment_offset(seq);
+    esp_err_t err = esp_partition_erase_range(s_part, off, ORDER_JOURNAL_SEGMENT_SIZE);
+    if (err == ESP_OK) {
+        err = esp_partition_write(s_part, off, &hdr, sizeof(hdr));
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_head_seq = seq;
+    s_head_off = sizeof(hdr);
+    return ESP_OK;
+}
+
+// 按段写入连续的记录，同一段内能放下的记录一次写入；first_seq 输出第一条记录所在段
+static esp_err_t write_records(const uint8_t *data, size_t len, uint32_t *first_seq)
+{
+    size_t pos = 0;
+    while (pos < len) {
+        size_t room = s_head_seq ? ORDER_JOURNAL_SEGMENT_SIZE - s_head_off : 0;
+        size_t chunk = 0;
+        while (pos + chunk < len) {
+            record_header_t hdr;
+            memcpy(&hdr, data + pos + chunk, sizeof(hdr));
+            size_t n = record_total(hdr.len);
+            if (chunk + n > room) break;
+            chunk += n;
+        }
+
+        if (chunk == 0) {
+            esp_err_t err = open_segment();
+            if (err != ESP_OK) {
+                return err;
+            }
+            continue;
+        }
+
+        if (first_seq && pos == 0) {
+            *first_seq = s_head_seq;
+        }
+        esp_err_t err = esp_partition_write(s_part, segment_offset(s_head_seq) + s_head_off, data + pos, chunk);
+        if (err != ESP_OK) {
+            return err;
+        }
+        s_head_off += chunk;
+        pos += chunk;
+    }
+    return ESP_OK;
+}
+
+typedef struct {
+    size_t len;
+    bool overflow;
+} snapshot_ctx_t;
+
+static void snapshot_order(order_info_t *order, void *arg)
+{
+    snapshot_ctx_t *ctx = arg;
+    size_t n = encode_record(s_snapshot + ctx->len, JOURNAL_SNAPSHOT_SIZE - ctx->len, REC_UPSERT, order, NULL);
+    if (n == 0) {
+        ctx->overflow = true;
+    }
+    ctx->len += n;
+}
+
+// 写入检查点：之前缓冲的记录先落盘，然后是全部订单的快照
+static void journal_checkpoint(void)
+{
+    snapshot_ctx_t ctx = { 0 };
+    size_t pending;
+
+    // 订单存储只在显示锁内访问；两把锁的顺序与UI侧一致
+    bsp_display_lock(portMAX_DELAY);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    memcpy(s_flush, s_buf, s_buf_len);
+    pending = s_buf_len;
+    s_buf_len = 0;
+    s_resync = false;
+    ctx.len = encode_record(s_snapshot, JOURNAL_SNAPSHOT_SIZE, REC_CKPT_BEGIN, NULL, NULL);
+    order_store_foreach(snapshot_order, &ctx);
+    size_t end = encode_record(s_snapshot + ctx.len, JOURNAL_SNAPSHOT_SIZE - ctx.len, REC_CKPT_END, NULL, NULL);
+    ctx.overflow |= end == 0;
+    ctx.len += end;
+    xSemaphoreGive(s_lock);
+    bsp_display_unlock();
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = write_records(s_flush, pending, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "写入日志失败: %s", esp_err_to_name(err));
+    }
+    if (ctx.overflow) {
+        ESP_LOGE(TAG, "订单快照超过 %d 字节，检查点未写入", JOURNAL_SNAPSHOT_SIZE);
+        return;
+    }
+
+    uint32_t ckpt_seq = 0;
+    err = write_records(s_snapshot, ctx.len, &ckpt_seq);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "写入检查点失败: %s", esp_err_to_name(err));
+        return;
+    }
+    s_ckpt_seq = ckpt_seq;
+    ESP_LOGI(TAG, "检查点: %u 字节，起始段 %u，耗时 %lld ms",
+             (unsigned)ctx.len, (unsigned)ckpt_seq, (esp_timer_get_time() - start_us) / 1000);
+}
+
+static void journal_task_fn(void *arg)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ORDER_JOURNAL_FLUSH_MS));
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool resync = s_resync;
+        xSemaphoreGive(s_lock);
+
+        // 回放范围超过日志区一半时压缩，保证快照总有空间写入
+        if (resync || s_head_seq + 1 - s_ckpt_seq > ORDER_JOURNAL_SEGMENTS / 2) {
+            journal_checkpoint();
+            continue;
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        size_t len = s_buf_len;
+        memcpy(s_flush, s_buf, len);
+        s_buf_len = 0;
+        xSemaphoreGive(s_lock);
+
+        if (len > 0) {
+            esp_err_t err = write_records(s_flush, len, NULL);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "写入日志失败: %s", esp_err_to_name(err));
+                xSemaphoreTake(s_lock, portMAX_DELAY);
+                s_resync = true;
+                xSemaphoreGive(s_lock);
+            }
+        }
+    }
+}
+
+// ---------- 回放 ----------
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} reader_t;
+
+static bool get(reader_t *r, void *v, size_t n)
+{
+    if ((size_t)(r->end - r->p) < n) return false;
+    memcpy(v, r->p, n);
+    r->p += n;
+    return true;
+}
+
+static bool get_id(reader_t *r, char *id)
+{
+    uint8_t len;
+    if (!get(r, &len, 1) || len == 0 || len >= ORDER_ID_MAX_LEN || !get(r, id, len)) {
+        return false;
+    }
+    id[len] = '\0';
+    return true;
+}
+
+static bool replay_upsert(reader_t *r)
+{
+    char id[ORDER_ID_MAX_LEN];
+    uint32_t num, deadline;
+    uint8_t priority, done;
+    uint16_t count;
+    if (!get_id(r, id) || !get(r, &num, 4) || !get(r, &priority, 1) || !get(r, &deadline, 4) ||
+        !get(r, &done, 1) || !get(r, &count, 2)) {
+        return false;
+    }
+
+    order_info_t *order = order_store_find(id);
+    if (!order && order_store_add(id, (int)num, &order) != ESP_OK) {
+        return false;
+    }
+    order->order_num = (int)num;
+    order->done = done;
+    order_store_set_priority(order, priority, deadline);
+    order->item_count = 0;
+    order->text_len = 0;
+    if (!order_store_reserve_dishes(order, count, r->end - r->p)) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        uint16_t name_len, mods_len, qty;
+        uint8_t station;
+        if (!get(r, &name_len, 2) || !get(r, &mods_len, 2) || !get(r, &qty, 2) || !get(r, &station, 1) ||
+            (size_t)(r->end - r->p) < (size_t)name_len + mods_len) {
+            return false;
+        }
+        const char *name = (const char *)r->p;
+        const char *mods = name + name_len;
+        r->p += name_len + mods_len;
+        if (!order_store_append_dish(order, name, name_len, qty, mods, mods_len, station)) {
+            return false;
+        }
+    }
+    order_store_route(order);
+    return true;
+}
+
+static void replay_record(uint8_t type, const uint8_t *payload, size_t len)
+{
+    reader_t r = { payload, payload + len };
+    char id[ORDER_ID_MAX_LEN];
+
+    switch (type) {
+    case REC_UPSERT:
+        if (!replay_upsert(&r)) {
+            ESP_LOGW(TAG, "订单记录无法恢复，已跳过");
+        }
+        break;
+    case REC_REMOVE:
+        if (get_id(&r, id)) {
+            order_info_t *order = order_store_find(id);
+            if (order) {
+                order_store_remove(order);
+            }
+        }
+        break;
+    case REC_CLEAR:
+        order_store_clear();
+        break;
+    default:
+        break;
+    }
+}
+
+typedef struct {
+    uint32_t seq;
+    size_t off;
+} journal_pos_t;
+
+// 回放从最后一个完整检查点开始（订单存储为空），其后未写完的检查点只是重复的整单写入，无需特殊处理。
+// 遍历 [from, last_seq] 范围内的记录；段内遇到擦除状态或CRC错误（写入中途掉电）即转到下一段
+static int walk_records(const uint8_t *region, journal_pos_t from, uint32_t last_seq, bool apply,
+                        journal_pos_t *ckpt)
+{
+    journal_pos_t cand = { 0 };
+    int count = 0;
+
+    for (uint32_t seq = from.seq; seq <= last_seq; seq++) {
+        const uint8_t *seg = region + segment_offset(seq) - ORDER_JOURNAL_REGION_OFFSET;
+        size_t off = seq == from.seq ? from.off : sizeof(segment_header_t);
+
+        while (off + sizeof(record_header_t) <= ORDER_JOURNAL_SEGMENT_SIZE) {
+            record_header_t hdr;
+            memcpy(&hdr, seg + off, sizeof(hdr));
+            size_t total = record_total(hdr.len);
+            if (hdr.len == 0xFFFF || off + total > ORDER_JOURNAL_SEGMENT_SIZE) {
+                break;
+            }
+            const uint8_t *payload = seg + off + sizeof(hdr);
+            if (record_crc(hdr.type, payload, hdr.len) != hdr.crc) {
+                ESP_LOGW(TAG, "段 %u 偏移 %u 处记录校验失败", (unsigned)seq, (unsigned)off);
+                break;
+            }
+
+            if (apply) {
+                replay_record(hdr.type, payload, hdr.len);
+                count++;
+            } else if (hdr.type == REC_CKPT_BEGIN) {
+                cand = (journal_pos_t){ seq, off };
+            } else if (hdr.type == REC_CKPT_END && cand.seq) {
+                *ckpt = cand;
+            }
+            off += total;
+        }
+    }
+    return count;
+}
+
+static bool segment_valid(const uint8_t *region, uint32_t index, uint32_t *seq)
+{
+    segment_header_t hdr;
+    memcpy(&hdr, region + (size_t)index * ORDER_JOURNAL_SEGMENT_SIZE, sizeof(hdr));
+    if (hdr.magic != JOURNAL_MAGIC || hdr.seq == 0 || hdr.seq % ORDER_JOURNAL_SEGMENTS != index ||
+        hdr.crc != segment_crc(&hdr)) {
+        return false;
+    }
+    *seq = hdr.seq;
+    return true;
+}
+
+static void journal_replay(void)
+{
+    const void *ptr;
+    esp_partition_mmap_handle_t handle;
+    if (esp_partition_mmap(s_part, ORDER_JOURNAL_REGION_OFFSET, ORDER_JOURNAL_REGION_SIZE,
+                           ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "映射日志区失败，跳过回放");
+        return;
+    }
+    const uint8_t *region = ptr;
+    int64_t start_us = esp_timer_get_time();
+
+    // 最新的段，以及向前连续的段
+    uint32_t seqs[ORDER_JOURNAL_SEGMENTS];
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < ORDER_JOURNAL_SEGMENTS; i++) {
+        if (!segment_valid(region, i, &seqs[i])) {
+            seqs[i] = 0;
+        } else if (seqs[i] > last) {
+            last = seqs[i];
+        }
+    }
+
+    int records = 0;
+    if (last) {
+        uint32_t first = last;
+        while (first > 1 && last - first + 1 < ORDER_JOURNAL_SEGMENTS &&
+               seqs[(first - 1) % ORDER_JOURNAL_SEGMENTS] == first - 1) {
+            first--;
+        }
+
+        journal_pos_t from = { first, sizeof(segment_header_t) };
+        journal_pos_t ckpt = { 0 };
+        walk_records(region, from, last, false, &ckpt);
+        if (ckpt.seq) {
+            from = ckpt;
+        }
+        records = walk_records(region, from, last, true, NULL);
+
+        s_ckpt_seq = from.seq;
+        s_head_seq = last;
+        s_head_off = ORDER_JOURNAL_SEGMENT_SIZE;    // 末段可能有写了一半的记录，从新段继续
+    }
+    esp_partition_munmap(handle);
+
+    ESP_LOGI(TAG, "日志回放: %d 条记录, 恢复 %d 个订单, 耗时 %lld ms",
+             records, order_store_count(), (esp_timer_get_time() - start_us) / 1000);
+}
+
+esp_err_t order_journal_init(void)
+{
+    if (s_lock) {
+        return ESP_OK;
+    }
+
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    if (!s_part) {
+        ESP_LOGW(TAG, "未找到 storage 分区，订单日志不可用");
+        return ESP_OK;
+    }
+    if (s_part->size < ORDER_JOURNAL_REGION_OFFSET + ORDER_JOURNAL_REGION_SIZE) {
+        ESP_LOGE(TAG, "storage 分区过小，订单日志不可用: %u 字节", (unsigned)s_part->size);
+        s_part = NULL;
+        return ESP_OK;
+    }
+
+    s_buf = heap_caps_malloc(ORDER_JOURNAL_BUFFER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_flush = heap_caps_malloc(ORDER_JOURNAL_BUFFER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_snapshot = heap_caps_malloc(JOURNAL_SNAPSHOT_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_buf || !s_flush || !s_snapshot || !s_lock) {
+        ESP_LOGE(TAG, "日志缓冲区分配失败");
+        heap_caps_free(s_buf);
+        heap_caps_free(s_flush);
+        heap_caps_free(s_snapshot);
+        s_buf = s_flush = s_snapshot = NULL;
+        if (s_lock) {
+            vSemaphoreDelete(s_lock);
+            s_lock = NULL;
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    journal_replay();
+
+    if (xTaskCreate(journal_task_fn, "order_journal", JOURNAL_TASK_STACK_SIZE,
+                    NULL, JOURNAL_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建日志任务失败");
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
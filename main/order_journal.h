@@ -0,0 +1,50 @@
+/**
+ * @file order_journal.h
+ * @brief 订单日志：掉电/重启后恢复未完成的订单
+ *
+ * 订单的变化（整单写入、移除、清空）以追加方式写入 storage 分区中菜品目录区之后的日志区，
+ * 每条记录带CRC。记录先进入内存缓冲区，由日志任务定期成批写入flash。
+ * 日志区划分为若干段循环使用，各段轮流擦除，实现磨损均衡；
+ * 使用量超过一半时写入一次全部订单的快照（检查点），之前的段随后可被覆盖。
+ * 启动时从最后一个完整检查点开始回放到订单存储，在UI创建之前完成。
+ */
+
+#ifndef ORDER_JOURNAL_H
+#define ORDER_JOURNAL_H
+
+#include "esp_err.h"
+#include "menu_catalog.h"
+#include "order_store.h"
+
+#define ORDER_JOURNAL_REGION_OFFSET (MENU_CATALOG_REGION_OFFSET + MENU_CATALOG_REGION_SIZE)
+#define ORDER_JOURNAL_SEGMENT_SIZE  (16 * 1024)     // 单条记录不跨段
+#define ORDER_JOURNAL_SEGMENTS      64
+#define ORDER_JOURNAL_REGION_SIZE   (ORDER_JOURNAL_SEGMENT_SIZE * ORDER_JOURNAL_SEGMENTS)
+#define ORDER_JOURNAL_BUFFER_SIZE   (32 * 1024)     // 待写入记录的内存缓冲区
+#define ORDER_JOURNAL_FLUSH_MS      500             // 成批写入的最长间隔
+
+/**
+ * @brief 回放日志到订单存储并启动日志任务
+ *
+ * 须在 order_store_init 之后、UI创建之前调用。分区不存在时日志不可用，返回 ESP_OK。
+ */
+esp_err_t order_journal_init(void);
+
+/**
+ * @brief 记录订单的当前内容（新订单、整单更新、增量编辑之后）
+ *
+ * 以下三个函数由持有显示锁的UI代码调用，只写内存缓冲区，不阻塞在flash上。
+ */
+void order_journal_upsert(const order_info_t *order);
+
+/**
+ * @brief 记录订单被移除（出餐完成或POS删除）
+ */
+void order_journal_remove(const char *order_id);
+
+/**
+ * @brief 记录全部订单被清空
+ */
+void order_journal_clear(void);
+
+#endif // ORDER_JOURNAL_H
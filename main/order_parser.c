@@ -0,0 +1,744 @@
+/**
+ * @file order_parser.c
+ * @brief 订单消息的零分配流式解析器
+ *
+ * 取代 cJSON DOM：逐字符扫描一次，键值直接写入 order_record_t，
+ * 未识别的字段只跳过不保存。
+ */
+
+#include "order_parser.h"
+#include "hex_utils.h"
+#include "utf8_validator.h"
+#include "menu_catalog.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "OrderParser";
+
+#define JSON_MAX_DEPTH 16
+
+typedef struct {
+    const char *p;
+    const char *end;
+    const char *start;
+} json_cursor_t;
+
+// 同一含义的多个键名按优先级取值：压缩键名优先于旧键名
+typedef struct {
+    int type_rank;
+    int id_rank;
+    int items_rank;
+    int command_rank;
+    char type_str[12];
+} parse_state_t;
+
+static inline void skip_ws(json_cursor_t *c)
+{
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\n' || *c->p == '\r')) {
+        c->p++;
+    }
+}
+
+static inline char peek(json_cursor_t *c)
+{
+    skip_ws(c);
+    return c->p < c->end ? *c->p : '\0';
+}
+
+static inline bool consume(json_cursor_t *c, char ch)
+{
+    if (peek(c) == ch) {
+        c->p++;
+        return true;
+    }
+    return false;
+}
+
+static int hex_digit(char ch)
+{
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+static bool parse_u4(json_cursor_t *c, uint32_t *out)
+{
+    if (c->end - c->p < 4) return false;
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        int d = hex_digit(c->p[i]);
+        if (d < 0) return false;
+        v = (v << 4) | (uint32_t)d;
+    }
+    c->p += 4;
+    *out = v;
+    return true;
+}
+
+// 写入一个码点的UTF-8编码；空间不足时整个码点都不写
+static size_t put_utf8(char *out, size_t cap, size_t n, uint32_t cp, bool *truncated)
+{
+    char tmp[4];
+    size_t len;
+
+    if (cp < 0x80) {
+        tmp[0] = (char)cp;
+        len = 1;
+    } else if (cp < 0x800) {
+        tmp[0] = (char)(0xC0 | (cp >> 6));
+        tmp[1] = (char)(0x80 | (cp & 0x3F));
+        len = 2;
+    } else if (cp < 0x10000) {
+        tmp[0] = (char)(0xE0 | (cp >> 12));
+        tmp[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[2] = (char)(0x80 | (cp & 0x3F));
+        len = 3;
+    } else {
+        tmp[0] = (char)(0xF0 | (cp >> 18));
+        tmp[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        tmp[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[3] = (char)(0x80 | (cp & 0x3F));
+        len = 4;
+    }
+
+    if (!out) return n;
+    if (n + len > cap) {
+        *truncated = true;
+        return n;
+    }
+    memcpy(out + n, tmp, len);
+    return n + len;
+}
+
+/**
+ * 解析JSON字符串（光标位于开头引号），解码转义后写入 out。
+ * out 为NULL时只跳过。超出 cap 的部分丢弃并置 truncated。
+ */
+static bool parse_string(json_cursor_t *c, char *out, size_t cap, size_t *out_len, bool *truncated)
+{
+    size_t n = 0;
+    bool trunc = false;
+
+    if (!consume(c, '"')) return false;
+
+    while (c->p < c->end) {
+        char ch = *c->p++;
+
+        if (ch == '"') {
+            if (out_len) *out_len = n;
+            if (truncated) *truncated = trunc;
+            return true;
+        }
+        if ((unsigned char)ch < 0x20) return false;
+
+        if (ch == '\\') {
+            if (c->p >= c->end) return false;
+            char esc = *c->p++;
+            switch (esc) {
+            case '"': case '\\': case '/': ch = esc; break;
+            case 'b': ch = '\b'; break;
+            case 'f': ch = '\f'; break;
+            case 'n': ch = '\n'; break;
+            case 'r': ch = '\r'; break;
+            case 't': ch = '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!parse_u4(c, &cp)) return false;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t lo;
+                    if (c->end - c->p < 6 || c->p[0] != '\\' || c->p[1] != 'u') return false;
+                    c->p += 2;
+                    if (!parse_u4(c, &lo) || lo < 0xDC00 || lo > 0xDFFF) return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return false;
+                }
+                n = put_utf8(out, cap, n, cp, &trunc);
+                continue;
+            }
+            default:
+                return false;
+            }
+        }
+
+        if (out) {
+            if (n < cap) {
+                out[n++] = ch;
+            } else {
+                trunc = true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool match_literal(json_cursor_t *c, const char *lit, size_t len)
+{
+    if ((size_t)(c->end - c->p) < len || memcmp(c->p, lit, len) != 0) return false;
+    c->p += len;
+    return true;
+}
+
+static bool is_number_char(char ch)
+{
+    return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+}
+
+static bool parse_number(json_cursor_t *c, double *out)
+{
+    char tmp[32];
+    size_t n = 0;
+
+    skip_ws(c);
+    while (c->p < c->end && is_number_char(*c->p)) {
+        if (n >= sizeof(tmp) - 1) return false;
+        tmp[n++] = *c->p++;
+    }
+    if (n == 0) return false;
+    tmp[n] = '\0';
+
+    char *endp;
+    double v = strtod(tmp, &endp);
+    if (*endp != '\0') return false;
+    if (out) *out = v;
+    return true;
+}
+
+static bool parse_bool(json_cursor_t *c, bool *out)
+{
+    skip_ws(c);
+    if (match_literal(c, "true", 4)) {
+        *out = true;
+        return true;
+    }
+    if (match_literal(c, "false", 5)) {
+        *out = false;
+        return true;
+    }
+    return false;
+}
+
+static bool skip_value(json_cursor_t *c, int depth)
+{
+    if (depth > JSON_MAX_DEPTH) return false;
+
+    switch (peek(c)) {
+    case '"':
+        return parse_string(c, NULL, 0, NULL, NULL);
+    case '{':
+        c->p++;
+        if (consume(c, '}')) return true;
+        for (;;) {
+            if (!parse_string(c, NULL, 0, NULL, NULL) || !consume(c, ':') || !skip_value(c, depth + 1)) {
+                return false;
+            }
+            if (consume(c, ',')) continue;
+            return consume(c, '}');
+        }
+    case '[':
+        c->p++;
+        if (consume(c, ']')) return true;
+        for (;;) {
+            if (!skip_value(c, depth + 1)) return false;
+            if (consume(c, ',')) continue;
+            return consume(c, ']');
+        }
+    case 't':
+        return match_literal(c, "true", 4);
+    case 'f':
+        return match_literal(c, "false", 5);
+    case 'n':
+        return match_literal(c, "null", 4);
+    default:
+        return parse_number(c, NULL);
+    }
+}
+
+typedef enum {
+    APPEND_OK,
+    APPEND_FULL,        // 空间不足，字符串已跳过
+    APPEND_SYNTAX,      // 语法错误
+} append_result_t;
+
+// 把已就地解码的字节重新编码为十六进制（解码结果不是有效UTF-8时恢复原文，大小写统一为小写）
+static void hex_restore(char *dst, size_t decoded)
+{
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = decoded; i-- > 0;) {
+        uint8_t b = (uint8_t)dst[i];
+        dst[2 * i] = digits[b >> 4];
+        dst[2 * i + 1] = digits[b & 0x0F];
+    }
+}
+
+/**
+ * 把字符串值追加到记录 text 区域（NUL结尾）。若内容为十六进制编码则就地解码。
+ * glyphs 不为NULL时输出码点数。
+ */
+static append_result_t append_text(json_cursor_t *c, order_record_t *rec, uint16_t *off, uint16_t *len,
+                                   uint16_t *glyphs)
+{
+    if (rec->text_len >= ORDER_TEXT_MAX) {
+        rec->truncated = true;
+        return parse_string(c, NULL, 0, NULL, NULL) ? APPEND_FULL : APPEND_SYNTAX;
+    }
+
+    size_t cap = ORDER_TEXT_MAX - rec->text_len - 1;   // 保留结尾NUL
+    char *dst = rec->text + rec->text_len;
+    size_t n = 0;
+    bool trunc = false;
+
+    if (!parse_string(c, dst, cap, &n, &trunc)) {
+        return APPEND_SYNTAX;
+    }
+    if (trunc) {
+        rec->truncated = true;
+        return APPEND_FULL;
+    }
+
+    dst[n] = '\0';
+    if (n > 0 && n % 2 == 0) {
+        // 解码到原文之后的空闲区，失败或解码结果不是有效UTF-8时原文保持不变；
+        // 空闲区不足时先校验再就地解码
+        int decoded = -1;
+        if (n + 1 + n / 2 <= cap) {
+            decoded = hex_decode(dst, n, (uint8_t *)dst + n + 1, n / 2);
+            if (decoded > 0 && utf8_is_valid((uint8_t *)dst + n + 1, decoded)) {
+                memcpy(dst, dst + n + 1, decoded);
+            } else {
+                decoded = -1;
+            }
+        } else if (hex_is_valid_n(dst, n)) {
+            decoded = hex_decode(dst, n, (uint8_t *)dst, n);
+            if (decoded > 0 && !utf8_is_valid((uint8_t *)dst, decoded)) {
+                hex_restore(dst, decoded);
+                decoded = -1;
+            }
+        }
+        if (decoded > 0) {
+            n = decoded;
+            dst[n] = '\0';
+        }
+    }
+
+    if (glyphs) {
+        // 整帧已在接收时校验过，这里只统计码点数
+        size_t count = 0;
+        utf8_validate_count((const uint8_t *)dst, n, &count);
+        *glyphs = (uint16_t)count;
+    }
+
+    *off = rec->text_len;
+    *len = n;
+    rec->text_len += n + 1;
+    return APPEND_OK;
+}
+
+static uint16_t to_menu_id(double v)
+{
+    return (v >= 1 && v < MENU_CATALOG_MAX_ID) ? (uint16_t)v : 0;
+}
+
+// 解析单个菜品：字符串 "菜品名"、目录ID 12，或对象 {"name": "...", "q": 2, "mods": "少辣", "st": 1} / {"id": 12, "q": 2}
+static bool parse_item(json_cursor_t *c, order_record_t *rec)
+{
+    bool full = rec->item_count >= ORDER_MAX_ITEMS;
+    order_item_t item = { .qty = 1, .station = ORDER_STATION_UNSET };
+    bool has_name = false;
+    uint16_t menu_id = 0;
+    uint8_t station = ORDER_STATION_UNSET;
+    uint16_t text_mark = rec->text_len;
+
+    char ch = peek(c);
+    if (ch == '-' || (ch >= '0' && ch <= '9')) {
+        double id;
+        if (!parse_number(c, &id)) return false;
+        if (full) {
+            rec->truncated = true;
+            return true;
+        }
+        menu_id = to_menu_id(id);
+    } else if (ch == '"') {
+        if (full) {
+            rec->truncated = true;
+            return skip_value(c, 1);
+        }
+        append_result_t r = append_text(c, rec, &item.name_off, &item.name_len, &item.glyphs);
+        if (r == APPEND_SYNTAX) return false;
+        has_name = r == APPEND_OK;
+    } else if (ch == '{') {
+        c->p++;
+        if (!consume(c, '}')) {
+            for (;;) {
+                char key[8];
+                size_t klen = 0;
+                bool ktrunc = false;
+                if (!parse_string(c, key, sizeof(key) - 1, &klen, &ktrunc) || !consume(c, ':')) {
+                    return false;
+                }
+                key[ktrunc ? 0 : klen] = '\0';
+
+                if (!full && !has_name && (strcmp(key, "name") == 0 || strcmp(key, "n") == 0) && peek(c) == '"') {
+                    append_result_t r = append_text(c, rec, &item.name_off, &item.name_len, &item.glyphs);
+                    if (r == APPEND_SYNTAX) return false;
+                    has_name = r == APPEND_OK;
+                } else if ((strcmp(key, "q") == 0 || strcmp(key, "qty") == 0) && peek(c) != '"') {
+                    double q;
+                    if (!parse_number(c, &q)) return false;
+                    item.qty = (q >= 0 && q <= 999) ? (uint16_t)q : 1;    // 0 仅对增量编辑有效
+                } else if (!full && !item.has_mods && (strcmp(key, "mods") == 0 || strcmp(key, "m") == 0) &&
+                           peek(c) == '"') {
+                    append_result_t r = append_text(c, rec, &item.mods_off, &item.mods_len, NULL);
+                    if (r == APPEND_SYNTAX) return false;
+                    item.has_mods = r == APPEND_OK;
+                } else if (strcmp(key, "id") == 0 && peek(c) != '"') {
+                    double id;
+                    if (!parse_number(c, &id)) return false;
+                    menu_id = to_menu_id(id);
+                } else if ((strcmp(key, "st") == 0 || strcmp(key, "station") == 0) && peek(c) != '"') {
+                    double v;
+                    if (!parse_number(c, &v)) return false;
+                    station = (v >= 0 && v <= UINT8_MAX) ? (uint8_t)v : 0;
+                } else if (!skip_value(c, 2)) {
+                    return false;
+                }
+
+                if (consume(c, ',')) continue;
+                if (consume(c, '}')) break;
+                return false;
+            }
+        }
+        if (full) {
+            rec->truncated = true;
+        }
+    } else {
+        // 无效格式，跳过
+        return skip_value(c, 1);
+    }
+
+    // 只有ID时从目录取菜名；同时携带菜名时以菜名为准
+    if (!has_name && menu_id && !full) {
+        has_name = menu_catalog_fill_item(rec, menu_id, &item) != ESP_ERR_NO_MEM;
+    }
+    // 消息指定的工位（包括工位0）优先于目录
+    if (station != ORDER_STATION_UNSET) {
+        item.station = station;
+    }
+
+    if (has_name) {
+        rec->items[rec->item_count++] = item;
+    } else {
+        rec->text_len = text_mark;
+    }
+    return true;
+}
+
+static bool parse_items(json_cursor_t *c, order_record_t *rec)
+{
+    // 更高优先级的菜品键覆盖之前的结果（已写入的文本不回收）
+    rec->item_count = 0;
+
+    if (!consume(c, '[')) return false;
+    if (consume(c, ']')) return true;
+
+    for (;;) {
+        if (!parse_item(c, rec)) return false;
+        if (consume(c, ',')) continue;
+        return consume(c, ']');
+    }
+}
+
+// 解析目录项 [ID, "菜名", 工位, 分类]，工位与分类可省略；多余的元素忽略
+static bool parse_menu_entry(json_cursor_t *c, order_record_t *rec)
+{
+    if (peek(c) != '[') {
+        return skip_value(c, 1);
+    }
+    c->p++;
+
+    bool full = rec->item_count >= ORDER_MAX_ITEMS;
+    order_item_t item = { .qty = 1, .station = ORDER_STATION_UNSET };
+    bool has_name = false;
+    uint16_t text_mark = rec->text_len;
+
+    if (!consume(c, ']')) {
+        for (int k = 0;; k++) {
+            char vt = peek(c);
+            if (k == 1 && vt == '"' && !full) {
+                append_result_t r = append_text(c, rec, &item.name_off, &item.name_len, &item.glyphs);
+                if (r == APPEND_SYNTAX) return false;
+                has_name = r == APPEND_OK;
+            } else if (k != 1 && k <= 3 && vt != '"' && vt != '[' && vt != '{') {
+                double v;
+                if (!parse_number(c, &v)) return false;
+                if (k == 0) {
+                    item.menu_id = to_menu_id(v);
+                } else if (k == 2) {
+                    item.station = (v >= 0 && v <= UINT8_MAX) ? (uint8_t)v : 0;
+                } else {
+                    item.category = (v >= 0 && v <= UINT8_MAX) ? (uint8_t)v : 0;
+                }
+            } else if (!skip_value(c, 2)) {
+                return false;
+            }
+
+            if (consume(c, ',')) continue;
+            if (consume(c, ']')) break;
+            return false;
+        }
+    }
+
+    if (full) {
+        rec->truncated = true;
+    } else if (has_name) {
+        rec->items[rec->item_count++] = item;
+    } else {
+        rec->text_len = text_mark;
+    }
+    return true;
+}
+
+static bool parse_menu(json_cursor_t *c, order_record_t *rec)
+{
+    rec->item_count = 0;
+
+    if (!consume(c, '[')) return false;
+    if (consume(c, ']')) return true;
+
+    for (;;) {
+        if (!parse_menu_entry(c, rec)) return false;
+        if (consume(c, ',')) continue;
+        return consume(c, ']');
+    }
+}
+
+static bool parse_uint(json_cursor_t *c, uint32_t max, uint32_t *out)
+{
+    double v;
+    if (!parse_number(c, &v)) return false;
+    *out = (v >= 0 && v <= max) ? (uint32_t)v : 0;
+    return true;
+}
+
+static bool parse_into(json_cursor_t *c, char *out, size_t size, bool *truncated)
+{
+    size_t n = 0;
+    bool trunc = false;
+    if (!parse_string(c, out, size - 1, &n, &trunc)) return false;
+    out[n] = '\0';
+    if (truncated) *truncated = trunc;
+    return true;
+}
+
+static bool parse_field(json_cursor_t *c, order_record_t *rec, parse_state_t *st, const char *key)
+{
+    char vt = peek(c);
+
+    if ((strcmp(key, "t") == 0 || strcmp(key, "type") == 0) && vt == '"') {
+        int rank = key[1] ? 1 : 2;
+        if (rank > st->type_rank) {
+            st->type_rank = rank;
+            return parse_into(c, st->type_str, sizeof(st->type_str), NULL);
+        }
+    } else if ((strcmp(key, "o") == 0 || strcmp(key, "orderId") == 0) && vt == '"') {
+        int rank = key[1] ? 1 : 2;
+        if (rank > st->id_rank) {
+            bool trunc = false;
+            st->id_rank = rank;
+            if (!parse_into(c, rec->order_id, sizeof(rec->order_id), &trunc)) return false;
+            if (trunc) {
+                ESP_LOGW(TAG, "订单ID过长，已忽略");
+                rec->order_id[0] = '\0';
+            }
+            return true;
+        }
+    } else if ((strcmp(key, "i") == 0 || strcmp(key, "c") == 0 || strcmp(key, "items") == 0) && vt == '[') {
+        int rank = key[0] == 'i' ? (key[1] ? 1 : 3) : 2;
+        if (rank > st->items_rank) {
+            st->items_rank = rank;
+            return parse_items(c, rec);
+        }
+    } else if ((strcmp(key, "c") == 0 || strcmp(key, "command") == 0) && vt == '"') {
+        int rank = key[1] ? 1 : 2;
+        if (rank > st->command_rank) {
+            st->command_rank = rank;
+            return parse_into(c, rec->command, sizeof(rec->command), NULL);
+        }
+    } else if ((strcmp(key, "s") == 0 || strcmp(key, "status") == 0) && (vt == 't' || vt == 'f')) {
+        rec->has_status = true;
+        return parse_bool(c, &rec->status);
+    } else if (strcmp(key, "content") == 0 && vt == '"' && !rec->has_content) {
+        append_result_t r = append_text(c, rec, &rec->content_off, &rec->content_len, NULL);
+        rec->has_content = r == APPEND_OK;
+        return r != APPEND_SYNTAX;
+    } else if ((strcmp(key, "b") == 0 || strcmp(key, "ops") == 0) && vt == '[' && rec->batch_len == 0) {
+        // 批量操作只记录位置，由调用方逐个解析到各自的记录中
+        const char *begin = c->p;
+        if (!skip_value(c, 1)) return false;
+        if (begin - c->start > UINT16_MAX || c->p - begin > UINT16_MAX) return false;
+        rec->batch_off = begin - c->start;
+        rec->batch_len = c->p - begin;
+        return true;
+    } else if ((strcmp(key, "q") == 0 || strcmp(key, "seq") == 0) && vt != '"') {
+        double seq;
+        if (!parse_number(c, &seq)) return false;
+        if (seq >= 0 && seq <= UINT32_MAX) {
+            rec->has_seq = true;
+            rec->seq = (uint32_t)seq;
+        }
+        return true;
+    } else if ((strcmp(key, "pr") == 0 || strcmp(key, "priority") == 0) && vt != '"') {
+        uint32_t v;
+        if (!parse_uint(c, UINT8_MAX, &v)) return false;
+        rec->has_priority = true;
+        rec->priority = (uint8_t)v;
+        return true;
+    } else if ((strcmp(key, "dl") == 0 || strcmp(key, "deadline") == 0) && vt != '"') {
+        uint32_t v;
+        if (!parse_uint(c, UINT32_MAX, &v)) return false;
+        rec->has_priority = true;
+        rec->deadline = v;
+        return true;
+    } else if ((strcmp(key, "m") == 0 || strcmp(key, "menu") == 0) && vt == '[') {
+        return parse_menu(c, rec);
+    } else if ((strcmp(key, "v") == 0 || strcmp(key, "version") == 0) && vt != '"') {
+        return parse_uint(c, UINT32_MAX, &rec->menu_version);
+    } else if ((strcmp(key, "p") == 0 || strcmp(key, "part") == 0 ||
+                strcmp(key, "pc") == 0 || strcmp(key, "parts") == 0) && vt != '"') {
+        uint32_t v;
+        if (!parse_uint(c, UINT8_MAX, &v)) return false;
+        if (key[1] == '\0' || strcmp(key, "part") == 0) {
+            rec->menu_part = (uint8_t)v;
+        } else {
+            rec->menu_parts = (uint8_t)v;
+        }
+        return true;
+    } else if (strcmp(key, "timestamp") == 0) {
+        if (vt == '"') {
+            return parse_into(c, rec->timestamp_text, sizeof(rec->timestamp_text), NULL);
+        }
+        double ts;
+        if (parse_number(c, &ts)) {
+            rec->timestamp = (long long)ts;
+            return true;
+        }
+        return false;
+    }
+
+    return skip_value(c, 1);
+}
+
+static order_msg_type_t resolve_type(const char *type_str)
+{
+    if (strcmp(type_str, "info") == 0 || strcmp(type_str, "i") == 0) return ORDER_MSG_INFO;
+    if (strcmp(type_str, "add") == 0 || strcmp(type_str, "a") == 0) return ORDER_MSG_ADD;
+    if (strcmp(type_str, "update") == 0 || strcmp(type_str, "u") == 0) return ORDER_MSG_UPDATE;
+    if (strcmp(type_str, "remove") == 0 || strcmp(type_str, "r") == 0) return ORDER_MSG_REMOVE;
+    if (strcmp(type_str, "batch") == 0 || strcmp(type_str, "b") == 0) return ORDER_MSG_BATCH;
+    if (strcmp(type_str, "menu") == 0 || strcmp(type_str, "m") == 0) return ORDER_MSG_MENU;
+    if (strcmp(type_str, "edit") == 0 || strcmp(type_str, "e") == 0) return ORDER_MSG_EDIT;
+    return ORDER_MSG_UNKNOWN;
+}
+
+esp_err_t order_parser_parse(const char *json, size_t len, order_record_t *rec)
+{
+    json_cursor_t c = { .p = json, .end = json + len, .start = json };
+    parse_state_t st = {0};
+
+    order_record_reset(rec);
+
+    if (!consume(&c, '{')) return ESP_ERR_INVALID_ARG;
+
+    if (!consume(&c, '}')) {
+        for (;;) {
+            char key[12];
+            size_t klen = 0;
+            bool ktrunc = false;
+
+            if (!parse_string(&c, key, sizeof(key) - 1, &klen, &ktrunc) || !consume(&c, ':')) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            key[ktrunc ? 0 : klen] = '\0';
+
+            if (!parse_field(&c, rec, &st, key)) {
+                return ESP_ERR_INVALID_ARG;
+            }
+
+            if (consume(&c, ',')) continue;
+            if (consume(&c, '}')) break;
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (rec->truncated) {
+        ESP_LOGW(TAG, "菜品数量或文本超过限制，已截断");
+    }
+
+    rec->type = resolve_type(st.type_str);
+    if (rec->type == ORDER_MSG_UNKNOWN) {
+        ESP_LOGW(TAG, "缺少或未知的type字段: %s", st.type_str);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (rec->type != ORDER_MSG_EDIT) {
+        // 数量0只在增量编辑中表示删除，其他消息按1处理
+        for (int i = 0; i < rec->item_count; i++) {
+            if (rec->items[i].qty == 0) {
+                rec->items[i].qty = 1;
+            }
+        }
+    }
+
+    if (order_msg_is_order_op(rec->type)) {
+        rec->order_num = order_parser_number_from_id(rec->order_id);
+    }
+    return ESP_OK;
+}
+
+esp_err_t order_parser_for_each_op(const char *ops, size_t len, order_parser_op_cb_t cb, void *ctx)
+{
+    json_cursor_t c = { .p = ops, .end = ops + len, .start = ops };
+
+    if (!consume(&c, '[')) return ESP_ERR_INVALID_ARG;
+    if (consume(&c, ']')) return ESP_OK;
+
+    for (;;) {
+        bool is_object = peek(&c) == '{';
+        const char *begin = c.p;
+        if (!skip_value(&c, 1)) return ESP_ERR_INVALID_ARG;
+        if (is_object) {
+            cb(begin, c.p - begin, ctx);
+        }
+        if (consume(&c, ',')) continue;
+        return consume(&c, ']') ? ESP_OK : ESP_ERR_INVALID_ARG;
+    }
+}
+
+int order_parser_number_from_id(const char *order_id)
+{
+    if (!order_id || order_id[0] == '\0') {
+        return 1;
+    }
+
+    int order_num;
+    size_t len = strlen(order_id);
+
+    // 尝试从订单ID末尾提取数字
+    if (len > 4) {
+        order_num = atoi(order_id + len - 4);
+        if (order_num <= 0) {
+            // 如果末尾提取失败，尝试整个字符串
+            order_num = atoi(order_id);
+        }
+    } else {
+        order_num = atoi(order_id);
+    }
+
+    // 确保订单号在合理范围内
+    if (order_num <= 0 || order_num > 999999) {
+        order_num = 1;
+    }
+    return order_num;
+}
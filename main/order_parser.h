@@ -0,0 +1,49 @@
+#ifndef ORDER_PARSER_H
+#define ORDER_PARSER_H
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "order_record.h"
+
+/**
+ * @brief 单遍解析订单/信息JSON消息，直接写入固定大小的订单记录
+ *
+ * 只识别已知的消息结构，同时支持压缩键名与旧键名：
+ * t/type（含增量编辑 edit/e）, o/orderId, i/c/items, s/status, c/command, content, timestamp, b/ops, q/seq，
+ * 以及菜单同步消息的 m/menu, v/version, p/part, pc/parts。
+ * 菜品可以是菜名或目录ID，ID在解析时从菜品目录取出菜名。
+ * 菜品名与content若为十六进制编码则就地解码。整个过程不做堆分配。
+ *
+ * @param json JSON文本（无需NUL结尾）
+ * @param len JSON长度
+ * @param rec 输出记录，调用前内容会被清空
+ * @return ESP_OK 解析成功
+ * @return ESP_ERR_INVALID_ARG JSON语法错误
+ * @return ESP_ERR_NOT_SUPPORTED 缺少或未知的type字段
+ */
+esp_err_t order_parser_parse(const char *json, size_t len, order_record_t *rec);
+
+/**
+ * @brief 批量消息中单个操作的回调
+ *
+ * @param op 操作对象的JSON文本（不含结尾NUL）
+ * @param op_len 长度
+ * @param ctx 用户参数
+ */
+typedef void (*order_parser_op_cb_t)(const char *op, size_t op_len, void *ctx);
+
+/**
+ * @brief 遍历批量消息的操作数组，对每个对象元素调用回调
+ *
+ * @param ops 操作数组的JSON文本，即记录中 batch_off/batch_len 指向的部分
+ * @param len 长度
+ * @return ESP_OK 遍历完成；ESP_ERR_INVALID_ARG 语法错误
+ */
+esp_err_t order_parser_for_each_op(const char *ops, size_t len, order_parser_op_cb_t cb, void *ctx);
+
+/**
+ * @brief 从订单ID生成订单号（取末尾4位数字，失败时为1）
+ */
+int order_parser_number_from_id(const char *order_id);
+
+#endif // ORDER_PARSER_H
@@ -0,0 +1,216 @@
+#include "order_reasm.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const char *TAG = "OrderReasm";
+
+typedef enum {
+    SLOT_FREE = 0,
+    SLOT_FILLING,       // 正在接收分片
+    SLOT_COMPLETE,      // 已交给调用方，等待归还
+} slot_state_t;
+
+typedef struct {
+    slot_state_t state;
+    uint16_t conn_handle;
+    uint8_t encoding;
+    uint8_t msg_id;
+    uint8_t next_idx;
+    uint8_t count;
+    size_t len;
+    TickType_t last_tick;
+    uint8_t *buf;       // ORDER_REASM_MSG_MAX + 1 字节
+} reasm_slot_t;
+
+static reasm_slot_t s_slots[ORDER_REASM_SLOTS];
+static uint8_t *s_storage = NULL;
+static order_reasm_stats_t s_stats;
+
+esp_err_t order_reasm_init(void)
+{
+    if (s_storage) {
+        return ESP_OK;
+    }
+
+    s_storage = heap_caps_malloc(ORDER_REASM_SLOTS * (ORDER_REASM_MSG_MAX + 1),
+                                 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_storage) {
+        ESP_LOGE(TAG, "重组缓冲池分配失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < ORDER_REASM_SLOTS; i++) {
+        s_slots[i].state = SLOT_FREE;
+        s_slots[i].buf = s_storage + i * (ORDER_REASM_MSG_MAX + 1);
+    }
+
+    ESP_LOGI(TAG, "重组缓冲池: %d 个 x %d 字节", ORDER_REASM_SLOTS, ORDER_REASM_MSG_MAX);
+    return ESP_OK;
+}
+
+static void drop_slot(reasm_slot_t *slot)
+{
+    slot->state = SLOT_FREE;
+    s_stats.active--;
+}
+
+static reasm_slot_t *find_slot(uint16_t conn_handle, uint8_t msg_id)
+{
+    for (int i = 0; i < ORDER_REASM_SLOTS; i++) {
+        reasm_slot_t *slot = &s_slots[i];
+        if (slot->state == SLOT_FILLING && slot->conn_handle == conn_handle && slot->msg_id == msg_id) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+// 取空闲槽位，没有时淘汰最久未更新的重组
+static reasm_slot_t *claim_slot(void)
+{
+    reasm_slot_t *oldest = NULL;
+    TickType_t now = xTaskGetTickCount();
+
+    for (int i = 0; i < ORDER_REASM_SLOTS; i++) {
+        reasm_slot_t *slot = &s_slots[i];
+        if (slot->state == SLOT_FREE) {
+            return slot;
+        }
+        if (slot->state == SLOT_FILLING &&
+            (!oldest || now - slot->last_tick > now - oldest->last_tick)) {
+            oldest = slot;
+        }
+    }
+
+    if (oldest) {
+        ESP_LOGW(TAG, "重组槽位已满，淘汰消息 conn=%d id=%d (%d/%d)",
+                 oldest->conn_handle, oldest->msg_id, oldest->next_idx, oldest->count);
+        drop_slot(oldest);
+        s_stats.evicted++;
+    }
+    return oldest;
+}
+
+esp_err_t order_reasm_feed(uint16_t conn_handle, uint8_t encoding,
+                           const uint8_t *data, size_t len, order_reasm_msg_t *out)
+{
+    if (!s_storage || !order_reasm_is_fragment(data, len)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t msg_id = data[1];
+    uint8_t idx = data[2];
+    uint8_t count = data[3];
+    const uint8_t *payload = data + ORDER_FRAG_HEADER_LEN;
+    size_t payload_len = len - ORDER_FRAG_HEADER_LEN;
+
+    if (count == 0 || idx >= count) {
+        s_stats.rejected++;
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    reasm_slot_t *slot = find_slot(conn_handle, msg_id);
+    if (idx == 0) {
+        // 新消息的首片；同ID未完成的旧消息视为被放弃
+        if (slot) {
+            drop_slot(slot);
+            s_stats.evicted++;
+        } else {
+            slot = claim_slot();
+            if (!slot) {
+                s_stats.rejected++;
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        slot->state = SLOT_FILLING;
+        slot->conn_handle = conn_handle;
+        slot->encoding = encoding;
+        slot->msg_id = msg_id;
+        slot->next_idx = 0;
+        slot->count = count;
+        slot->len = 0;
+        s_stats.active++;
+    } else if (!slot || slot->next_idx != idx || slot->count != count) {
+        ESP_LOGW(TAG, "分片乱序或缺失: conn=%d id=%d idx=%d", conn_handle, msg_id, idx);
+        if (slot) {
+            drop_slot(slot);
+        }
+        s_stats.rejected++;
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (slot->len + payload_len > ORDER_REASM_MSG_MAX) {
+        ESP_LOGW(TAG, "重组消息超过 %d 字节，已丢弃", ORDER_REASM_MSG_MAX);
+        drop_slot(slot);
+        s_stats.rejected++;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memcpy(slot->buf + slot->len, payload, payload_len);
+    slot->len += payload_len;
+    slot->next_idx++;
+    slot->last_tick = xTaskGetTickCount();
+
+    if (slot->next_idx < slot->count) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    slot->state = SLOT_COMPLETE;
+    s_stats.completed++;
+
+    out->conn_handle = slot->conn_handle;
+    out->encoding = slot->encoding;
+    out->len = slot->len;
+    out->data = slot->buf;
+    out->slot = slot - s_slots;
+    return ESP_OK;
+}
+
+void order_reasm_release(order_reasm_msg_t *msg)
+{
+    if (!msg || msg->slot < 0 || msg->slot >= ORDER_REASM_SLOTS) return;
+
+    reasm_slot_t *slot = &s_slots[msg->slot];
+    if (slot->state == SLOT_COMPLETE) {
+        drop_slot(slot);
+    }
+    msg->slot = -1;
+}
+
+void order_reasm_drop_conn(uint16_t conn_handle)
+{
+    for (int i = 0; i < ORDER_REASM_SLOTS; i++) {
+        reasm_slot_t *slot = &s_slots[i];
+        if (slot->state == SLOT_FILLING && slot->conn_handle == conn_handle) {
+            ESP_LOGW(TAG, "连接断开，丢弃未完成消息: conn=%d id=%d (%d/%d)",
+                     conn_handle, slot->msg_id, slot->next_idx, slot->count);
+            drop_slot(slot);
+            s_stats.evicted++;
+        }
+    }
+}
+
+uint32_t order_reasm_evict_expired(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    for (int i = 0; i < ORDER_REASM_SLOTS; i++) {
+        reasm_slot_t *slot = &s_slots[i];
+        if (slot->state == SLOT_FILLING && now - slot->last_tick >= pdMS_TO_TICKS(ORDER_REASM_TIMEOUT_MS)) {
+            ESP_LOGW(TAG, "重组超时: conn=%d id=%d (%d/%d)",
+                     slot->conn_handle, slot->msg_id, slot->next_idx, slot->count);
+            drop_slot(slot);
+            s_stats.evicted++;
+        }
+    }
+    return s_stats.active;
+}
+
+void order_reasm_get_stats(order_reasm_stats_t *stats)
+{
+    if (!stats) return;
+    *stats = s_stats;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file order_reasm.h
+ * @brief 应用层分片重组
+ *
+ * 超过单次写入上限的消息由POS拆成多片写入同一特征，每片带分片头:
+ * [魔数 0xFA][消息ID u8][分片序号 u8][分片总数 u8][负载]
+ * JSON帧以 '{' 开头，TLV帧以版本号 1 开头，魔数不会与二者冲突。
+ * 同一连接上的分片按序到达，在PSRAM缓冲池中按 (连接, 消息ID) 拼接，
+ * 超时未完成的消息会被淘汰。仅在解析任务中调用，不加锁。
+ */
+
+#ifndef ORDER_REASM_H
+#define ORDER_REASM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ORDER_FRAG_MAGIC        0xFA
+#define ORDER_FRAG_HEADER_LEN   4
+#define ORDER_REASM_MSG_MAX     8192  // 重组后消息最大字节数
+#define ORDER_REASM_MSG_MAX_STR "8192"
+#define ORDER_REASM_SLOTS       4     // 同时进行中的重组数量
+#define ORDER_REASM_TIMEOUT_MS  3000  // 两个分片之间的最长间隔
+
+// 重组完成的消息，data 后预留1字节可写入结束符
+typedef struct {
+    uint16_t conn_handle;
+    uint8_t encoding;
+    size_t len;
+    uint8_t *data;
+    int slot;               // 内部使用
+} order_reasm_msg_t;
+
+typedef struct {
+    uint32_t completed;     // 重组完成的消息数
+    uint32_t evicted;       // 超时或被抢占淘汰的消息数
+    uint32_t rejected;      // 乱序、超长或头部无效的分片数
+    uint32_t active;        // 进行中的重组数量
+} order_reasm_stats_t;
+
+/**
+ * @brief 分配重组缓冲池（位于PSRAM）
+ */
+esp_err_t order_reasm_init(void);
+
+/**
+ * @brief 判断一帧是否带分片头
+ */
+static inline bool order_reasm_is_fragment(const uint8_t *data, size_t len)
+{
+    return len >= ORDER_FRAG_HEADER_LEN && data[0] == ORDER_FRAG_MAGIC;
+}
+
+/**
+ * @brief 输入一个分片
+ *
+ * @param out 消息完整时填充，使用完后必须调用 order_reasm_release
+ * @return ESP_OK 消息已完整
+ * @return ESP_ERR_NOT_FINISHED 等待后续分片
+ * @return ESP_ERR_INVALID_ARG 分片头无效或乱序，对应消息被丢弃
+ * @return ESP_ERR_INVALID_SIZE 重组后超过 ORDER_REASM_MSG_MAX
+ * @return ESP_ERR_NO_MEM 没有可用的重组缓冲区
+ */
+esp_err_t order_reasm_feed(uint16_t conn_handle, uint8_t encoding,
+                           const uint8_t *data, size_t len, order_reasm_msg_t *out);
+
+/**
+ * @brief 归还已完成消息占用的缓冲区
+ */
+void order_reasm_release(order_reasm_msg_t *msg);
+
+/**
+ * @brief 丢弃某个连接上未完成的重组（连接断开时）
+ */
+void order_reasm_drop_conn(uint16_t conn_handle);
+
+/**
+ * @brief 淘汰超时的重组
+ *
+ * @return 仍在进行中的重组数量
+ */
+uint32_t order_reasm_evict_expired(void);
+
+/**
+ * @brief 获取重组统计
+ */
+void order_reasm_get_stats(order_reasm_stats_t *stats);
+
+#endif // ORDER_REASM_H
@@ -0,0 +1,86 @@
+#include "order_record.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+static const char *TAG = "OrderRecord";
+
+static order_record_t *s_records = NULL;
+static QueueHandle_t s_free_records = NULL;  // 空闲记录指针队列
+
+esp_err_t order_record_pool_init(void)
+{
+    if (s_records) {
+        return ESP_OK;
+    }
+
+    s_records = heap_caps_calloc(ORDER_RECORD_POOL_SIZE, sizeof(order_record_t),
+                                 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_free_records = xQueueCreate(ORDER_RECORD_POOL_SIZE, sizeof(order_record_t *));
+    if (!s_records || !s_free_records) {
+        ESP_LOGE(TAG, "记录池分配失败");
+        heap_caps_free(s_records);
+        s_records = NULL;
+        if (s_free_records) {
+            vQueueDelete(s_free_records);
+            s_free_records = NULL;
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < ORDER_RECORD_POOL_SIZE; i++) {
+        order_record_t *rec = &s_records[i];
+        xQueueSend(s_free_records, &rec, 0);
+    }
+
+    ESP_LOGI(TAG, "记录池: %d 条 x %d 字节", ORDER_RECORD_POOL_SIZE, (int)sizeof(order_record_t));
+    return ESP_OK;
+}
+
+order_record_t *order_record_acquire(uint32_t timeout_ms)
+{
+    order_record_t *rec = NULL;
+    TickType_t ticks = timeout_ms == ORDER_RECORD_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (!s_free_records || xQueueReceive(s_free_records, &rec, ticks) != pdTRUE) {
+        return NULL;
+    }
+    order_record_reset(rec);
+    return rec;
+}
+
+void order_record_release(order_record_t *rec)
+{
+    if (!rec) return;
+    xQueueSend(s_free_records, &rec, 0);
+}
+
+void order_record_reset(order_record_t *rec)
+{
+    // text 区域不需要清零，写入时总是显式结尾
+    rec->type = ORDER_MSG_UNKNOWN;
+    rec->order_id[0] = '\0';
+    rec->order_num = 0;
+    rec->has_status = false;
+    rec->status = false;
+    rec->truncated = false;
+    rec->has_seq = false;
+    rec->has_priority = false;
+    rec->priority = 0;
+    rec->deadline = 0;
+    rec->seq = 0;
+    rec->command[0] = '\0';
+    rec->timestamp = 0;
+    rec->timestamp_text[0] = '\0';
+    rec->has_content = false;
+    rec->content_off = 0;
+    rec->content_len = 0;
+    rec->batch_off = 0;
+    rec->batch_len = 0;
+    rec->menu_version = 0;
+    rec->menu_part = 0;
+    rec->menu_parts = 0;
+    rec->item_count = 0;
+    rec->text_len = 0;
+}
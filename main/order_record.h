@@ -0,0 +1,130 @@
+#ifndef ORDER_RECORD_H
+#define ORDER_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ORDER_ID_MAX_LEN        64    // 订单ID最大长度（含结束符）
+#define ORDER_MAX_ITEMS         128   // 单个订单最多菜品数
+#define ORDER_TEXT_MAX          8192  // 菜品名称与消息文本总字节数，与分片重组上限一致
+#define ORDER_COMMAND_MAX_LEN   16
+#define ORDER_TIMESTAMP_MAX_LEN 32
+#define ORDER_RECORD_POOL_SIZE  32    // 预分配记录数量
+#define ORDER_RECORD_WAIT_FOREVER UINT32_MAX
+
+// 协议消息类型
+typedef enum {
+    ORDER_MSG_UNKNOWN = 0,
+    ORDER_MSG_INFO,         // t: "info" / "i"
+    ORDER_MSG_ADD,          // t: "add" / "a"
+    ORDER_MSG_UPDATE,       // t: "update" / "u"
+    ORDER_MSG_REMOVE,       // t: "remove" / "r"
+    ORDER_MSG_BATCH,        // t: "batch" / "b"，b/ops 数组中每项为一条订单消息
+    ORDER_MSG_MENU,         // t: "menu" / "m"，菜品目录同步，items 为目录项
+    ORDER_MSG_EDIT,         // t: "edit" / "e"，增量编辑：每个菜品设置新数量，0 表示删除，未有的菜品追加
+} order_msg_type_t;
+
+#define ORDER_STATION_UNSET     0xFF  // 菜品的工位未指定，接收阶段按分类映射补全
+
+// 单个菜品，名称以NUL结尾存放在记录的 text 区域内
+typedef struct {
+    uint16_t name_off;
+    uint16_t name_len;
+    uint16_t qty;       // 增量编辑中可以为0
+    uint16_t glyphs;    // 名称的码点数，解析时随UTF-8校验得到，UI据此估算标签宽度
+    uint16_t menu_id;   // 目录中的菜品ID，0 表示订单直接携带菜名
+    uint8_t station;    // 出品工位（消息的 st 或目录，接收阶段按映射补全），ORDER_STATION_UNSET 表示未指定
+    uint8_t category;
+    bool has_mods;      // 消息是否携带备注字段（增量编辑中可用空备注清除原备注）
+    uint16_t mods_off;  // 备注（如"少辣、加蛋"），同样存放在 text 区域
+    uint16_t mods_len;
+} order_item_t;
+
+// 固定大小的订单记录，解析器直接写入，不做任何堆分配
+typedef struct {
+    order_msg_type_t type;
+    char order_id[ORDER_ID_MAX_LEN];
+    int order_num;
+    bool has_status;
+    bool status;                                // s / status
+    bool truncated;                             // 菜品或文本超出容量被截断
+    bool has_seq;
+    uint32_t seq;                               // q / seq，POS每个连接上递增的可选序号
+    bool has_priority;                          // 携带 pr 或 dl，更新/编辑消息据此重新排序
+    uint8_t priority;                           // pr / priority，越大越优先（加急、VIP），缺省0
+    uint32_t deadline;                          // dl / deadline，出餐期限（Unix秒），0 表示无期限
+    char command[ORDER_COMMAND_MAX_LEN];        // info 消息的 c / command
+    long long timestamp;                        // 数字时间戳（毫秒）
+    char timestamp_text[ORDER_TIMESTAMP_MAX_LEN]; // 字符串时间戳
+    bool has_content;
+    uint16_t content_off;                       // info 消息的 content
+    uint16_t content_len;
+    uint16_t batch_off;                         // 批量消息中操作数组在原始帧内的位置
+    uint16_t batch_len;
+    uint32_t menu_version;                      // 菜单同步消息的 v / version
+    uint8_t menu_part;                          // p / part，从0开始
+    uint8_t menu_parts;                         // pc / parts，缺省为1
+    uint8_t item_count;
+    order_item_t items[ORDER_MAX_ITEMS];
+    uint16_t text_len;
+    char text[ORDER_TEXT_MAX];
+} order_record_t;
+
+/**
+ * @brief 预分配记录池（位于PSRAM）
+ */
+esp_err_t order_record_pool_init(void);
+
+/**
+ * @brief 从记录池取出一条已清空的记录
+ *
+ * @param timeout_ms 池空时的等待时间，ORDER_RECORD_WAIT_FOREVER 表示一直等待
+ * @return order_record_t* 记录，超时返回NULL
+ */
+order_record_t *order_record_acquire(uint32_t timeout_ms);
+
+/**
+ * @brief 归还记录到记录池
+ */
+void order_record_release(order_record_t *rec);
+
+/**
+ * @brief 清空记录内容
+ */
+void order_record_reset(order_record_t *rec);
+
+/**
+ * @brief 获取第 idx 个菜品名称（NUL结尾）
+ */
+static inline const char *order_record_item_name(const order_record_t *rec, int idx)
+{
+    return rec->text + rec->items[idx].name_off;
+}
+
+/**
+ * @brief 获取第 idx 个菜品的备注（NUL结尾），无备注时返回空串
+ */
+static inline const char *order_record_item_mods(const order_record_t *rec, int idx)
+{
+    return rec->items[idx].mods_len ? rec->text + rec->items[idx].mods_off : "";
+}
+
+/**
+ * @brief 是否为针对单个订单的消息（携带订单ID与订单号）
+ */
+static inline bool order_msg_is_order_op(order_msg_type_t type)
+{
+    return type == ORDER_MSG_ADD || type == ORDER_MSG_UPDATE || type == ORDER_MSG_REMOVE || type == ORDER_MSG_EDIT;
+}
+
+/**
+ * @brief 获取 info 消息内容（NUL结尾），没有内容时返回NULL
+ */
+static inline const char *order_record_content(const order_record_t *rec)
+{
+    return rec->has_content ? rec->text + rec->content_off : NULL;
+}
+
+#endif // ORDER_RECORD_H
@@ -0,0 +1,100 @@
+#include "order_station.h"
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "OrderStation";
+
+#define STATION_NVS_NAMESPACE   "storage"
+#define STATION_NVS_KEY         "station_map"
+
+// 分类 → 工位，只在解析任务中读写
+static uint8_t s_map[UINT8_MAX + 1];
+
+esp_err_t order_station_init(void)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(STATION_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "没有保存的工位映射，菜品按协议与目录分配工位");
+        return ESP_OK;
+    }
+
+    size_t len = sizeof(s_map);
+    err = nvs_get_blob(nvs_handle, STATION_NVS_KEY, s_map, &len);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK || len != sizeof(s_map)) {
+        memset(s_map, 0, sizeof(s_map));
+        ESP_LOGI(TAG, "没有保存的工位映射，菜品按协议与目录分配工位");
+        return ESP_OK;
+    }
+
+    int mapped = 0;
+    for (int i = 0; i < (int)sizeof(s_map); i++) {
+        if (s_map[i] >= ORDER_STATION_MAX) {
+            s_map[i] = 0;
+        }
+        mapped += s_map[i] != 0;
+    }
+    ESP_LOGI(TAG, "工位映射已加载: %d 个分类", mapped);
+    return ESP_OK;
+}
+
+void order_station_resolve(order_record_t *rec)
+{
+    for (int i = 0; i < rec->item_count; i++) {
+        order_item_t *item = &rec->items[i];
+        if (item->station == ORDER_STATION_UNSET) {
+            item->station = s_map[item->category];
+        } else if (item->station >= ORDER_STATION_MAX) {
+            item->station = 0;
+        }
+    }
+}
+
+esp_err_t order_station_set_map(const char *spec)
+{
+    uint8_t map[sizeof(s_map)] = { 0 };
+    const char *p = spec;
+
+    while (*p) {
+        char *end;
+        long category = strtol(p, &end, 10);
+        if (end == p || *end != ':' || category < 0 || category > UINT8_MAX) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        p = end + 1;
+        long station = strtol(p, &end, 10);
+        if (end == p || station < 0 || station >= ORDER_STATION_MAX) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        map[category] = (uint8_t)station;
+        p = end;
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    memcpy(s_map, map, sizeof(s_map));
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(STATION_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "打开NVS失败: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = nvs_set_blob(nvs_handle, STATION_NVS_KEY, s_map, sizeof(s_map));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存工位映射失败: %s", esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "工位映射已更新: %s", spec);
+    }
+    return err;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file order_station.h
+ * @brief 出品工位：订单按工位拆分为子单
+ *
+ * 一路蓝牙订单同时供多个工位（烤炉、炸锅、饮品……）使用。每个菜品在接收阶段确定一次工位：
+ * 协议中的 st 字段优先（st 为0即指定工位0），其次为菜品目录中的工位，
+ * 都未指定（ORDER_STATION_UNSET）时按NVS中保存的分类→工位映射，映射中没有的分类归入工位0。
+ * 订单存储按工位维护各自的等待队列与焦点订单，UI按工位显示子单并分别确认出餐。
+ */
+
+#ifndef ORDER_STATION_H
+#define ORDER_STATION_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "order_record.h"
+
+#define ORDER_STATION_MAX       4       // 工位数（含工位0），工位号超出范围时归入工位0
+#define ORDER_STATION_MAP_CMD   "station_map"   // info 消息命令，content 为 "分类:工位,..."
+
+_Static_assert(ORDER_STATION_MAX <= 8, "工位集合以 uint8_t 位图保存");
+
+/**
+ * @brief 从NVS加载分类→工位映射，需在 nvs_flash_init 之后调用
+ */
+esp_err_t order_station_init(void);
+
+/**
+ * @brief 为记录中的每个菜品确定工位（解析任务，投递给UI之前调用一次）
+ *
+ * 未指定工位的菜品按分类映射补全，工位号超出范围的归入工位0。
+ */
+void order_station_resolve(order_record_t *rec);
+
+/**
+ * @brief 设置分类→工位映射并写入NVS（解析任务）
+ *
+ * @param spec "分类:工位" 以逗号分隔，如 "1:1,2:1,5:3"；未列出的分类归入工位0
+ * @return ESP_ERR_INVALID_ARG 格式错误或工位号超出范围，映射不变
+ */
+esp_err_t order_station_set_map(const char *spec);
+
+#endif // ORDER_STATION_H
@@ -0,0 +1,515 @@
+#include "order_store.h"
+#include "order_heap.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "OrderStore";
+
+#define STORE_INDEX_SIZE    16384                       // 不小于容量的2倍，负载因子不超过0.5
+#define STORE_INDEX_MASK    (STORE_INDEX_SIZE - 1)
+
+_Static_assert((STORE_INDEX_SIZE & STORE_INDEX_MASK) == 0, "索引大小必须为2的幂");
+_Static_assert(STORE_INDEX_SIZE >= ORDER_STORE_CAPACITY * 2, "索引负载因子不超过0.5");
+_Static_assert(ORDER_STORE_CAPACITY < UINT16_MAX, "索引槽以 uint16_t 保存池下标");
+
+TAILQ_HEAD(order_store_list, order_info);
+
+// 每条已分配的订单恰好在等待或处理中链表上，未分配的在空闲链表上
+static order_info_t *s_pool = NULL;
+static struct order_store_list s_free = TAILQ_HEAD_INITIALIZER(s_free);
+static struct order_store_list s_pending = TAILQ_HEAD_INITIALIZER(s_pending);
+static struct order_store_list s_processing = TAILQ_HEAD_INITIALIZER(s_processing);
+static int s_count = 0;
+static uint32_t s_arrival = 0;
+
+// 工位的子单队列：等待订单按处理顺序排好的数组 rank[lo, lo+count)，rank[lo] 为下一个要处理的订单
+// 容量等于订单池大小：订单在同一工位的队列中至多一次，池满之前工位队列不会满
+// 插入与删除二分查找定位后移动较短的一侧，两端留有空位，取队首只移动 lo；按名次读取不做比较
+typedef struct {
+    order_info_t *rank[ORDER_STORE_CAPACITY];
+    int lo;
+    int count;
+    order_info_t *focus;
+} station_queue_t;
+
+static station_queue_t *s_queues = NULL;    // ORDER_STATION_MAX 个，PSRAM
+
+// 开放寻址哈希索引，保存池下标+1，0 表示空槽
+static uint16_t s_index[STORE_INDEX_SIZE];
+
+static uint32_t id_hash(const char *id)
+{
+    uint32_t h = 0x811c9dc5;
+    while (*id) {
+        h ^= (uint8_t)*id++;
+        h *= 0x01000193;
+    }
+    return h;
+}
+
+static inline order_info_t *slot_order(int i)
+{
+    return &s_pool[s_index[i] - 1];
+}
+
+static int index_find(const char *order_id, uint32_t hash)
+{
+    for (int i = hash & STORE_INDEX_MASK; s_index[i]; i = (i + 1) & STORE_INDEX_MASK) {
+        order_info_t *order = slot_order(i);
+        if (order->hash == hash && strcmp(order->order_id, order_id) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void index_insert(order_info_t *order)
+{
+    int i = order->hash & STORE_INDEX_MASK;
+    while (s_index[i]) {
+        i = (i + 1) & STORE_INDEX_MASK;
+    }
+    s_index[i] = (uint16_t)(order - s_pool) + 1;
+}
+
+// 线性探测的删除：把后续同一探测链上的槽向前移动，不使用墓碑
+static void index_remove(int i)
+{
+    int j = i;
+    for (;;) {
+        j = (j + 1) & STORE_INDEX_MASK;
+        if (!s_index[j]) {
+            break;
+        }
+        int home = slot_order(j)->hash & STORE_INDEX_MASK;
+        // home 不在 (i, j] 区间内时，该槽可以移到空出的 i
+        bool between = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!between) {
+            s_index[i] = s_index[j];
+            i = j;
+        }
+    }
+    s_index[i] = 0;
+}
+
+// a 是否应排在 b 之前
+static bool order_before(const order_info_t *a, const order_info_t *b)
+{
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    if (a->deadline != b->deadline) {
+        // 有期限的排在无期限之前
+        if (!a->deadline || !b->deadline) {
+            return a->deadline != 0;
+        }
+        return a->deadline < b->deadline;
+    }
+    return (int32_t)(a->arrival - b->arrival) < 0;
+}
+
+// 第一个不排在 order 之前的名次；order 在队列中时即为其名次（顺序为全序，到达序号唯一）
+static int queue_lower_bound(const station_queue_t *q, const order_info_t *order)
+{
+    order_info_t *const *rank = &q->rank[q->lo];
+    int lo = 0;
+    int hi = q->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (order_before(rank[mid], order)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// 一端没有空位时把队列移到数组中间
+static void queue_recenter(station_queue_t *q)
+{
+    int lo = (ORDER_STORE_CAPACITY - q->count) / 2;
+    memmove(&q->rank[lo], &q->rank[q->lo], q->count * sizeof(q->rank[0]));
+    q->lo = lo;
+}
+
+static void queue_insert(int st, order_info_t *order)
+{
+    station_queue_t *q = &s_queues[st];
+    int pos = queue_lower_bound(q, order);
+    bool front = pos < q->count - pos;      // 前段较短时前段左移，否则后段右移
+    if (front ? q->lo == 0 : q->lo + q->count == ORDER_STORE_CAPACITY) {
+        queue_recenter(q);
+        if (q->lo == 0) {
+            front = false;
+        } else if (q->lo + q->count == ORDER_STORE_CAPACITY) {
+            front = true;
+        }
+    }
+    if (front) {
+        memmove(&q->rank[q->lo - 1], &q->rank[q->lo], pos * sizeof(q->rank[0]));
+        q->lo--;
+    } else {
+        memmove(&q->rank[q->lo + pos + 1], &q->rank[q->lo + pos], (q->count - pos) * sizeof(q->rank[0]));
+    }
+    q->rank[q->lo + pos] = order;
+    q->count++;
+    order->queued |= 1u << st;
+}
+
+static void queue_delete(int st, order_info_t *order)
+{
+    station_queue_t *q = &s_queues[st];
+    int pos = queue_lower_bound(q, order);
+    if (pos >= q->count || q->rank[q->lo + pos] != order) {
+        ESP_LOGE(TAG, "订单不在工位 %d 的队列中: %s", st, order->order_id);
+        order->queued &= ~(1u << st);
+        return;
+    }
+    if (pos < q->count - pos - 1) {
+        memmove(&q->rank[q->lo + 1], &q->rank[q->lo], pos * sizeof(q->rank[0]));
+        q->lo++;
+    } else {
+        memmove(&q->rank[q->lo + pos], &q->rank[q->lo + pos + 1], (q->count - pos - 1) * sizeof(q->rank[0]));
+    }
+    q->count--;
+    if (q->count == 0) {
+        q->lo = ORDER_STORE_CAPACITY / 2;
+    }
+    order->queued &= ~(1u << st);
+}
+
+static struct order_store_list *status_list(order_status_t status)
+{
+    return status == ORDER_STATUS_PENDING ? &s_pending : &s_processing;
+}
+
+// 焦点集合变化后，订单在等待与处理中链表之间移动
+static void update_status(order_info_t *order)
+{
+    order_status_t status = order->focus ? ORDER_STATUS_PROCESSING : ORDER_STATUS_PENDING;
+    if (status != order->status) {
+        TAILQ_REMOVE(status_list(order->status), order, entries);
+        order->status = status;
+        TAILQ_INSERT_TAIL(status_list(status), order, entries);
+    }
+}
+
+static inline bool station_queued(const order_info_t *order, int st)
+{
+    return (order->queued | order->focus) & (1u << st);
+}
+
+// 订单离开工位：从等待队列中删除，或清空该工位的焦点
+static void station_leave(order_info_t *order, int st)
+{
+    if (order->queued & (1u << st)) {
+        queue_delete(st, order);
+    } else if (order->focus & (1u << st)) {
+        order->focus &= ~(1u << st);
+        s_queues[st].focus = NULL;
+    }
+}
+
+esp_err_t order_store_init(void)
+{
+    if (s_pool) {
+        return ESP_OK;
+    }
+
+    // 订单堆区域分配失败时退回普通PSRAM分配，不影响运行
+    order_heap_init();
+
+    s_queues = heap_caps_calloc(ORDER_STATION_MAX, sizeof(station_queue_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_pool = heap_caps_calloc(ORDER_STORE_CAPACITY, sizeof(order_info_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_pool || !s_queues) {
+        ESP_LOGE(TAG, "订单池分配失败");
+        heap_caps_free(s_pool);
+        heap_caps_free(s_queues);
+        s_pool = NULL;
+        s_queues = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < ORDER_STORE_CAPACITY; i++) {
+        TAILQ_INSERT_TAIL(&s_free, &s_pool[i], entries);
+    }
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        s_queues[st].lo = ORDER_STORE_CAPACITY / 2;
+    }
+
+    ESP_LOGI(TAG, "订单池: %d 条 x %d 字节, %d 个工位队列 x %d 字节", ORDER_STORE_CAPACITY,
+             (int)sizeof(order_info_t), ORDER_STATION_MAX, (int)sizeof(station_queue_t));
+    return ESP_OK;
+}
+
+esp_err_t order_store_add(const char *order_id, int order_num, order_info_t **out)
+{
+    *out = NULL;
+    size_t len = strlen(order_id);
+    if (len == 0 || len >= ORDER_ID_MAX_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t hash = id_hash(order_id);
+    int slot = index_find(order_id, hash);
+    if (slot >= 0) {
+        *out = slot_order(slot);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    order_info_t *order = TAILQ_FIRST(&s_free);
+    if (!order) {
+        return ESP_ERR_NO_MEM;
+    }
+    TAILQ_REMOVE(&s_free, order, entries);
+
+    memcpy(order->order_id, order_id, len + 1);
+    order->order_num = order_num;
+    order->items = NULL;
+    order->item_count = 0;
+    order->item_cap = 0;
+    order->text = NULL;
+    order->text_len = 0;
+    order->text_cap = 0;
+    order->status = ORDER_STATUS_PENDING;
+    order->priority = 0;
+    order->deadline = 0;
+    order->arrival = s_arrival++;
+    order->stations = 0;
+    order->done = 0;
+    order->focus = 0;
+    order->queued = 0;
+    order->hash = hash;
+
+    index_insert(order);
+    TAILQ_INSERT_TAIL(&s_pending, order, entries);
+    s_count++;
+
+    *out = order;
+    return ESP_OK;
+}
+
+order_info_t *order_store_find(const char *order_id)
+{
+    if (!s_pool || !order_id) {
+        return NULL;
+    }
+    int slot = index_find(order_id, id_hash(order_id));
+    return slot >= 0 ? slot_order(slot) : NULL;
+}
+
+void order_store_remove(order_info_t *order)
+{
+    int slot = index_find(order->order_id, order->hash);
+    if (slot < 0 || slot_order(slot) != order) {
+        ESP_LOGE(TAG, "订单不在存储中: %s", order->order_id);
+        return;
+    }
+    index_remove(slot);
+
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        station_leave(order, st);
+    }
+    TAILQ_REMOVE(status_list(order->status), order, entries);
+    s_count--;
+
+    order_heap_free(order->items);
+    order_heap_free(order->text);
+    order->items = NULL;
+    order->text = NULL;
+    order->order_id[0] = '\0';
+    TAILQ_INSERT_HEAD(&s_free, order, entries);
+}
+
+void order_store_route(order_info_t *order)
+{
+    uint8_t stations = order->item_count ? 0 : 1;
+    for (int i = 0; i < order->item_count; i++) {
+        stations |= 1u << order->items[i].station;
+    }
+    uint8_t open = stations & ~order->done;
+
+    order->stations = stations;
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        bool queued = station_queued(order, st);
+        if ((open & (1u << st)) && !queued) {
+            queue_insert(st, order);
+        } else if (!(open & (1u << st)) && queued) {
+            station_leave(order, st);
+        }
+    }
+    update_status(order);
+}
+
+bool order_store_complete_station(order_info_t *order, uint8_t station)
+{
+    order->done |= 1u << station;
+    station_leave(order, station);
+    update_status(order);
+    return order_store_open_stations(order) == 0;
+}
+
+order_info_t *order_store_focus(uint8_t station)
+{
+    return s_queues ? s_queues[station].focus : NULL;
+}
+
+order_info_t *order_store_start_next(uint8_t station)
+{
+    station_queue_t *q = &s_queues[station];
+    if (q->count == 0) {
+        return NULL;
+    }
+    order_info_t *order = q->rank[q->lo];
+    queue_delete(station, order);
+
+    q->focus = order;
+    order->focus |= 1u << station;
+    update_status(order);
+    return order;
+}
+
+void order_store_set_priority(order_info_t *order, uint8_t priority, uint32_t deadline)
+{
+    if (order->priority == priority && order->deadline == deadline) {
+        return;
+    }
+    // 按旧的排序键删除，改键后重新插入
+    uint8_t queued = order->queued;
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        if (queued & (1u << st)) {
+            queue_delete(st, order);
+        }
+    }
+    order->priority = priority;
+    order->deadline = deadline;
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        if (queued & (1u << st)) {
+            queue_insert(st, order);
+        }
+    }
+}
+
+int order_store_pending_range(uint8_t station, int first, order_info_t **out, int max)
+{
+    if (!s_queues || first < 0) {
+        return 0;
+    }
+    const station_queue_t *q = &s_queues[station];
+    int n = q->count - first;
+    if (n > max) {
+        n = max;
+    }
+    if (n <= 0) {
+        return 0;
+    }
+    memcpy(out, &q->rank[q->lo + first], n * sizeof(out[0]));
+    return n;
+}
+
+int order_store_pending_count(uint8_t station)
+{
+    return s_queues ? s_queues[station].count : 0;
+}
+
+int order_store_count(void)
+{
+    return s_count;
+}
+
+bool order_store_reserve_dishes(order_info_t *order, size_t items, size_t text)
+{
+    if (items > UINT16_MAX || text > UINT16_MAX) {
+        return false;
+    }
+    if (items > order->item_cap) {
+        order_dish_t *p = order_heap_realloc(order->items, items * sizeof(order_dish_t));
+        if (!p) return false;
+        order->items = p;
+        order->item_cap = items;
+    }
+    if (text > order->text_cap) {
+        char *p = order_heap_realloc(order->text, text);
+        if (!p) return false;
+        order->text = p;
+        order->text_cap = text;
+    }
+    return true;
+}
+
+// 文本追加到订单的 text 区域（NUL结尾），返回偏移，失败返回-1
+static int text_add(order_info_t *order, const char *s, size_t len)
+{
+    size_t need = order->text_len + len + 1;
+    if (need > order->text_cap) {
+        size_t cap = order->text_cap ? order->text_cap : 64;
+        while (cap < need) cap *= 2;
+        if (!order_store_reserve_dishes(order, order->item_cap, cap > UINT16_MAX ? need : cap)) {
+            return -1;
+        }
+    }
+
+    int off = order->text_len;
+    memcpy(order->text + off, s, len);
+    order->text[off + len] = '\0';
+    order->text_len += len + 1;
+    return off;
+}
+
+bool order_store_set_dish_mods(order_info_t *order, order_dish_t *dish, const char *mods, size_t len)
+{
+    if (len == 0) {
+        dish->mods_off = 0;
+        dish->mods_len = 0;
+        return true;
+    }
+    int off = text_add(order, mods, len);
+    if (off < 0) return false;
+    dish->mods_off = off;
+    dish->mods_len = len;
+    return true;
+}
+
+bool order_store_append_dish(order_info_t *order, const char *name, size_t len, uint16_t qty,
+                              const char *mods, size_t mods_len, uint8_t station)
+{
+    if (order->item_count == order->item_cap &&
+        !order_store_reserve_dishes(order, order->item_cap ? order->item_cap * 2 : 8, order->text_cap)) {
+        return false;
+    }
+
+    order_dish_t *dish = &order->items[order->item_count];
+    int off = text_add(order, name, len);
+    if (off < 0) return false;
+    dish->name_off = off;
+    dish->name_len = len;
+    dish->qty = qty;
+    dish->station = station < ORDER_STATION_MAX ? station : 0;
+    if (!order_store_set_dish_mods(order, dish, mods, mods_len)) return false;
+    order->item_count++;
+    return true;
+}
+
+
+void order_store_foreach(void (*fn)(order_info_t *order, void *arg), void *arg)
+{
+    order_info_t *order;
+    TAILQ_FOREACH(order, &s_processing, entries) {
+        fn(order, arg);
+    }
+    TAILQ_FOREACH(order, &s_pending, entries) {
+        fn(order, arg);
+    }
+}
+
+void order_store_clear(void)
+{
+    order_info_t *order;
+    while ((order = TAILQ_FIRST(&s_pending)) != NULL) {
+        order_store_remove(order);
+    }
+    while ((order = TAILQ_FIRST(&s_processing)) != NULL) {
+        order_store_remove(order);
+    }
+}
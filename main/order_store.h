@@ -0,0 +1,176 @@
+/**
+ * @file order_store.h
+ * @brief 订单存储：预分配订单池 + 订单ID哈希索引 + 按工位的子单队列
+ *
+ * 订单记录从固定大小的池中分配，按订单ID建立开放寻址哈希索引；订单按到达顺序挂在双向链表上。
+ * 订单的菜品按工位拆分为子单：每个工位有一个按优先级、期限、到达顺序始终排好的数组（等待队列）
+ * 和一个焦点订单，队列容量与订单池相同，不会先于订单池占满。工位集合在菜品变化时计算一次。
+ * 查找为O(1)；进出队列以二分查找定位（O(log n) 次比较），移动较短一侧的指针；
+ * 取下一个等待订单为O(1)，按名次读取为O(读取数)且不做比较。
+ * 只在持有显示锁时调用（UI任务或LVGL回调），不另加锁。
+ */
+
+#ifndef ORDER_STORE_H
+#define ORDER_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sys/queue.h"
+#include "order_record.h"
+#include "order_station.h"
+
+#define ORDER_STORE_CAPACITY    5120    // 订单池大小（同时存在的订单数上限）
+
+typedef enum {
+    ORDER_STATUS_PENDING,      // 等待处理
+    ORDER_STATUS_PROCESSING,   // 处理中（至少一个工位的焦点）
+    ORDER_STATUS_COMPLETED     // 已完成
+} order_status_t;
+
+// 订单中的单个菜品，名称与备注以NUL结尾存放在订单的 text 区域
+typedef struct {
+    uint16_t name_off;
+    uint16_t name_len;
+    uint16_t mods_off;
+    uint16_t mods_len;         // 0 表示无备注
+    uint16_t qty;
+    uint8_t station;           // 出品工位，小于 ORDER_STATION_MAX
+} order_dish_t;
+
+typedef struct order_info {
+    char order_id[ORDER_ID_MAX_LEN];
+    int order_num;
+    order_dish_t *items;       // 菜品数组（订单堆），收到订单时一次建立，增量编辑就地修改
+    uint16_t item_count;
+    uint16_t item_cap;
+    char *text;                // 菜品名称与备注（订单堆）
+    uint16_t text_len;
+    uint16_t text_cap;
+    order_status_t status;
+    uint8_t priority;          // 越大越优先
+    uint32_t deadline;         // 出餐期限（Unix秒），0 表示无期限
+    uint32_t arrival;          // 到达序号，同优先级同期限时先到先做
+    uint8_t stations;          // 有菜品的工位（位图），无菜品的订单归工位0
+    uint8_t done;              // 已出餐的工位
+    uint8_t focus;             // 以本订单为焦点的工位
+    uint8_t queued;            // 在等待队列中的工位（位图）
+    uint32_t hash;             // 订单ID的哈希值，索引删除时使用
+    TAILQ_ENTRY(order_info) entries;
+} order_info_t;
+
+/**
+ * @brief 分配订单池（PSRAM）
+ */
+esp_err_t order_store_init(void);
+
+/**
+ * @brief 添加订单，状态为等待，优先级为0、无期限；加载菜品后调用 order_store_route 进入工位队列
+ *
+ * @param[out] out 新订单；订单ID已存在时为已有订单
+ * @return ESP_OK 成功
+ * @return ESP_ERR_INVALID_ARG 订单ID为空或过长
+ * @return ESP_ERR_INVALID_STATE 订单ID已存在
+ * @return ESP_ERR_NO_MEM 订单池已满或未初始化
+ */
+esp_err_t order_store_add(const char *order_id, int order_num, order_info_t **out);
+
+/**
+ * @brief 按订单ID查找，不存在返回NULL
+ */
+order_info_t *order_store_find(const char *order_id);
+
+/**
+ * @brief 移除订单并归还到池中，同时把菜品数组与文本区释放回订单堆
+ */
+void order_store_remove(order_info_t *order);
+
+/**
+ * @brief 按菜品的工位重新计算订单所属工位，进入新工位的等待队列，离开不再有菜品的工位
+ *
+ * 新订单加载菜品后、整单更新或增量编辑后调用；已出餐的工位不再进入队列。
+ * 离开某工位时若本订单是该工位的焦点，该工位的焦点随之清空。
+ * 每个订单在一个工位的队列中至多出现一次，工位队列按订单池容量分配，因此不会失败。
+ */
+void order_store_route(order_info_t *order);
+
+/**
+ * @brief 尚未出餐的工位（位图），为0时整单已完成
+ */
+static inline uint8_t order_store_open_stations(const order_info_t *order)
+{
+    return order->stations & ~order->done;
+}
+
+/**
+ * @brief 工位出餐：订单离开该工位的队列或焦点
+ *
+ * @return true 所有工位都已出餐
+ */
+bool order_store_complete_station(order_info_t *order, uint8_t station);
+
+/**
+ * @brief 工位的焦点订单，没有时返回NULL
+ */
+order_info_t *order_store_focus(uint8_t station);
+
+/**
+ * @brief 取出工位队列中排在最前的订单作为该工位的焦点，队列为空时返回NULL
+ *
+ * 顺序：优先级高者在前；同优先级时有期限且期限早者在前；其余按到达顺序。
+ * 调用前该工位不应有焦点订单。
+ */
+order_info_t *order_store_start_next(uint8_t station);
+
+/**
+ * @brief 调整订单的优先级与期限，订单随之在所在的各工位队列中移动
+ */
+void order_store_set_priority(order_info_t *order, uint8_t priority, uint32_t deadline);
+
+/**
+ * @brief 按处理顺序取出工位队列中第 first 名起的至多 max 个订单（不移除），用于滚动列表
+ *
+ * 队列始终按名次排好，每次调用为 O(max)，与队列长度无关。
+ *
+ * @return 实际取出的数量，first 超出队列长度时为0
+ */
+int order_store_pending_range(uint8_t station, int first, order_info_t **out, int max);
+
+/**
+ * @brief 工位等待队列中的订单数量（不含焦点订单）
+ */
+int order_store_pending_count(uint8_t station);
+
+/**
+ * @brief 订单总数
+ */
+int order_store_count(void);
+
+/**
+ * @brief 按处理中、等待（到达顺序）依次访问全部订单
+ */
+void order_store_foreach(void (*fn)(order_info_t *order, void *arg), void *arg);
+
+/**
+ * @brief 预留菜品数组与文本区容量，整单加载时按记录大小一次分配
+ */
+bool order_store_reserve_dishes(order_info_t *order, size_t items, size_t text);
+
+/**
+ * @brief 追加一个菜品，名称与备注复制到订单的 text 区域
+ */
+bool order_store_append_dish(order_info_t *order, const char *name, size_t len, uint16_t qty,
+                             const char *mods, size_t mods_len, uint8_t station);
+
+/**
+ * @brief 设置菜品备注，len 为0时清除；旧备注留在 text 区域直到下次整单加载
+ */
+bool order_store_set_dish_mods(order_info_t *order, order_dish_t *dish, const char *mods, size_t len);
+
+/**
+ * @brief 移除全部订单
+ */
+void order_store_clear(void);
+
+#endif // ORDER_STORE_H
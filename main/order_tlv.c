@@ -0,0 +1,297 @@
+/**
+ * @file order_tlv.c
+ * @brief 二进制TLV订单协议解码
+ */
+
+#include "order_tlv.h"
+#include "order_parser.h"
+#include "utf8_validator.h"
+#include "menu_catalog.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "OrderTLV";
+
+static bool read_varint(const uint8_t **p, const uint8_t *end, uint64_t *out)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64 && *p < end; shift += 7) {
+        uint8_t b = *(*p)++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool value_varint(const uint8_t *val, size_t len, uint64_t *out)
+{
+    const uint8_t *p = val;
+    return read_varint(&p, val + len, out) && p == val + len;
+}
+
+// 字符串值复制到记录 text 区域（NUL结尾），空间不足返回false
+static bool append_text(order_record_t *rec, const uint8_t *val, size_t len, uint16_t *off)
+{
+    if (rec->text_len + len + 1 > ORDER_TEXT_MAX) {
+        rec->truncated = true;
+        return false;
+    }
+    memcpy(rec->text + rec->text_len, val, len);
+    rec->text[rec->text_len + len] = '\0';
+    *off = rec->text_len;
+    rec->text_len += len + 1;
+    return true;
+}
+
+static void copy_string(char *dst, size_t size, const uint8_t *val, size_t len)
+{
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(dst, val, len);
+    dst[len] = '\0';
+}
+
+// 解码 [消息类型][TLV]... 部分
+static esp_err_t decode_body(const uint8_t *data, size_t len, order_record_t *rec, bool allow_batch)
+{
+    order_record_reset(rec);
+
+    if (len < 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t msg_type = data[0];
+    bool top_level_only = msg_type == ORDER_TLV_MSG_BATCH || msg_type == ORDER_TLV_MSG_MENU;
+    if (msg_type < ORDER_TLV_MSG_INFO || msg_type > ORDER_TLV_MSG_EDIT || (top_level_only && !allow_batch)) {
+        ESP_LOGW(TAG, "未知的TLV消息类型: %d", msg_type);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    rec->type = (order_msg_type_t)msg_type;
+
+    const uint8_t *p = data + 1;
+    const uint8_t *end = data + len;
+    bool has_order_num = false;
+
+    while (p < end) {
+        uint8_t tag = *p++;
+        uint64_t vlen;
+        if (!read_varint(&p, end, &vlen) || vlen > (uint64_t)(end - p)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        const uint8_t *val = p;
+        p += vlen;
+
+        // 帧内只有字符串值是UTF-8，逐个校验，码点数同时留给UI
+        size_t glyphs = 0;
+        bool is_text = tag == ORDER_TLV_TAG_ORDER_ID || tag == ORDER_TLV_TAG_ITEM ||
+                       tag == ORDER_TLV_TAG_COMMAND || tag == ORDER_TLV_TAG_CONTENT ||
+                       tag == ORDER_TLV_TAG_ITEM_MODS;
+        if (is_text && !utf8_validate_count(val, vlen, &glyphs)) {
+            ESP_LOGW(TAG, "标签 0x%02x 的值不是有效的UTF-8", tag);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        uint64_t num;
+        switch (tag) {
+        case ORDER_TLV_TAG_ORDER_ID:
+            if (vlen >= ORDER_ID_MAX_LEN) {
+                ESP_LOGW(TAG, "订单ID过长，已忽略");
+                break;
+            }
+            copy_string(rec->order_id, sizeof(rec->order_id), val, vlen);
+            break;
+        case ORDER_TLV_TAG_ORDER_NUM:
+            if (value_varint(val, vlen, &num) && num > 0 && num <= 999999) {
+                rec->order_num = (int)num;
+                has_order_num = true;
+            }
+            break;
+        case ORDER_TLV_TAG_ITEM: {
+            if (rec->item_count >= ORDER_MAX_ITEMS) {
+                rec->truncated = true;
+                break;
+            }
+            order_item_t *item = &rec->items[rec->item_count];
+            *item = (order_item_t){ .qty = 1, .station = ORDER_STATION_UNSET };
+            if (append_text(rec, val, vlen, &item->name_off)) {
+                item->name_len = vlen;
+                item->glyphs = (uint16_t)glyphs;
+                rec->item_count++;
+            }
+            break;
+        }
+        case ORDER_TLV_TAG_ITEM_ID:
+            if (rec->item_count >= ORDER_MAX_ITEMS) {
+                rec->truncated = true;
+                break;
+            }
+            if (value_varint(val, vlen, &num) && num >= 1 && num < MENU_CATALOG_MAX_ID) {
+                order_item_t *item = &rec->items[rec->item_count];
+                *item = (order_item_t){ .qty = 1, .station = ORDER_STATION_UNSET };
+                if (menu_catalog_fill_item(rec, (uint16_t)num, item) != ESP_ERR_NO_MEM) {
+                    rec->item_count++;
+                }
+            }
+            break;
+        case ORDER_TLV_TAG_MENU_VER:
+            if (value_varint(val, vlen, &num) && num <= UINT32_MAX) {
+                rec->menu_version = (uint32_t)num;
+            }
+            break;
+        case ORDER_TLV_TAG_MENU_PART: {
+            const uint8_t *q = val;
+            uint64_t part, parts;
+            if (read_varint(&q, val + vlen, &part) && read_varint(&q, val + vlen, &parts) &&
+                part <= UINT8_MAX && parts <= UINT8_MAX) {
+                rec->menu_part = (uint8_t)part;
+                rec->menu_parts = (uint8_t)parts;
+            }
+            break;
+        }
+        case ORDER_TLV_TAG_MENU_ITEM: {
+            const uint8_t *q = val;
+            const uint8_t *vend = val + vlen;
+            uint64_t id, station, category;
+            if (!read_varint(&q, vend, &id) || !read_varint(&q, vend, &station) ||
+                !read_varint(&q, vend, &category)) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            if (!utf8_validate_count(q, vend - q, &glyphs)) {
+                ESP_LOGW(TAG, "目录项 %u 的菜名不是有效的UTF-8", (unsigned)id);
+                return ESP_ERR_INVALID_ARG;
+            }
+            if (rec->item_count >= ORDER_MAX_ITEMS) {
+                rec->truncated = true;
+                break;
+            }
+            order_item_t *item = &rec->items[rec->item_count];
+            *item = (order_item_t){ .qty = 1, .station = ORDER_STATION_UNSET };
+            if (id < MENU_CATALOG_MAX_ID && append_text(rec, q, vend - q, &item->name_off)) {
+                item->name_len = vend - q;
+                item->glyphs = (uint16_t)glyphs;
+                item->menu_id = (uint16_t)id;
+                item->station = station <= UINT8_MAX ? (uint8_t)station : 0;
+                item->category = category <= UINT8_MAX ? (uint8_t)category : 0;
+                rec->item_count++;
+            }
+            break;
+        }
+        case ORDER_TLV_TAG_ITEM_QTY:
+            if (rec->item_count > 0 && value_varint(val, vlen, &num) && num <= 999 &&
+                (num >= 1 || rec->type == ORDER_MSG_EDIT)) {
+                rec->items[rec->item_count - 1].qty = (uint16_t)num;
+            }
+            break;
+        case ORDER_TLV_TAG_ITEM_STATION:
+            if (rec->item_count > 0 && value_varint(val, vlen, &num) && num <= UINT8_MAX) {
+                rec->items[rec->item_count - 1].station = (uint8_t)num;
+            }
+            break;
+        case ORDER_TLV_TAG_ITEM_MODS:
+            if (rec->item_count > 0) {
+                order_item_t *item = &rec->items[rec->item_count - 1];
+                if (append_text(rec, val, vlen, &item->mods_off)) {
+                    item->mods_len = vlen;
+                    item->has_mods = true;
+                }
+            }
+            break;
+        case ORDER_TLV_TAG_STATUS:
+            if (value_varint(val, vlen, &num)) {
+                rec->has_status = true;
+                rec->status = num != 0;
+            }
+            break;
+        case ORDER_TLV_TAG_COMMAND:
+            copy_string(rec->command, sizeof(rec->command), val, vlen);
+            break;
+        case ORDER_TLV_TAG_TIMESTAMP:
+            if (value_varint(val, vlen, &num)) {
+                rec->timestamp = (long long)num;
+            }
+            break;
+        case ORDER_TLV_TAG_SEQ:
+            if (value_varint(val, vlen, &num) && num <= UINT32_MAX) {
+                rec->has_seq = true;
+                rec->seq = (uint32_t)num;
+            }
+            break;
+        case ORDER_TLV_TAG_PRIORITY:
+            if (value_varint(val, vlen, &num) && num <= UINT8_MAX) {
+                rec->has_priority = true;
+                rec->priority = (uint8_t)num;
+            }
+            break;
+        case ORDER_TLV_TAG_DEADLINE:
+            if (value_varint(val, vlen, &num) && num <= UINT32_MAX) {
+                rec->has_priority = true;
+                rec->deadline = (uint32_t)num;
+            }
+            break;
+        case ORDER_TLV_TAG_CONTENT:
+            if (!rec->has_content && append_text(rec, val, vlen, &rec->content_off)) {
+                rec->content_len = vlen;
+                rec->has_content = true;
+            }
+            break;
+        default:
+            // 未知标签：跳过，兼容更新的发送端
+            break;
+        }
+    }
+
+    if (rec->truncated) {
+        ESP_LOGW(TAG, "菜品数量或文本超过限制，已截断");
+    }
+
+    if (order_msg_is_order_op(rec->type) && !has_order_num) {
+        rec->order_num = order_parser_number_from_id(rec->order_id);
+    }
+    return ESP_OK;
+}
+
+esp_err_t order_tlv_decode(const uint8_t *data, size_t len, order_record_t *rec)
+{
+    if (len < 2) {
+        order_record_reset(rec);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (data[0] != ORDER_TLV_VERSION) {
+        ESP_LOGW(TAG, "不支持的TLV版本: %d", data[0]);
+        order_record_reset(rec);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    return decode_body(data + 1, len - 1, rec, true);
+}
+
+esp_err_t order_tlv_decode_op(const uint8_t *op, size_t len, order_record_t *rec)
+{
+    return decode_body(op, len, rec, false);
+}
+
+esp_err_t order_tlv_for_each_op(const uint8_t *data, size_t len, order_tlv_op_cb_t cb, void *ctx)
+{
+    if (len < 2 || data[0] != ORDER_TLV_VERSION || data[1] != ORDER_TLV_MSG_BATCH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint8_t *p = data + 2;
+    const uint8_t *end = data + len;
+
+    while (p < end) {
+        uint8_t tag = *p++;
+        uint64_t vlen;
+        if (!read_varint(&p, end, &vlen) || vlen > (uint64_t)(end - p)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (tag == ORDER_TLV_TAG_OP) {
+            cb(p, vlen, ctx);
+        }
+        p += vlen;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file order_tlv.h
+ * @brief 二进制TLV订单协议
+ *
+ * 帧格式: [版本 u8][消息类型 u8][TLV]...
+ * 每个TLV: [标签 u8][长度 varint][值]
+ * 整数值（订单号、数量、时间戳）以小端LEB128 varint编码，字符串为原始UTF-8。
+ */
+
+#ifndef ORDER_TLV_H
+#define ORDER_TLV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "order_record.h"
+
+#define ORDER_TLV_VERSION 1
+#define ORDER_TLV_VERSION_STR "1"
+
+// 消息类型，与 order_msg_type_t 取值一致
+#define ORDER_TLV_MSG_INFO      1
+#define ORDER_TLV_MSG_ADD       2
+#define ORDER_TLV_MSG_UPDATE    3
+#define ORDER_TLV_MSG_REMOVE    4
+#define ORDER_TLV_MSG_BATCH     5   // 仅包含 OP 字段
+#define ORDER_TLV_MSG_MENU      6   // 菜品目录同步，不能出现在批量中
+#define ORDER_TLV_MSG_EDIT      7   // 增量编辑，ITEM_QTY 为0表示删除该菜品
+
+// 字段标签
+#define ORDER_TLV_TAG_ORDER_ID  0x01  // 字符串
+#define ORDER_TLV_TAG_ORDER_NUM 0x02  // varint
+#define ORDER_TLV_TAG_ITEM      0x03  // 字符串，每个菜品一个
+#define ORDER_TLV_TAG_ITEM_QTY  0x04  // varint，作用于前一个菜品
+#define ORDER_TLV_TAG_STATUS    0x05  // varint，非0表示出餐完成
+#define ORDER_TLV_TAG_COMMAND   0x06  // 字符串
+#define ORDER_TLV_TAG_TIMESTAMP 0x07  // varint，毫秒
+#define ORDER_TLV_TAG_CONTENT   0x08  // 字符串
+#define ORDER_TLV_TAG_OP        0x09  // 批量中的一条操作: [消息类型 u8][TLV]...
+#define ORDER_TLV_TAG_SEQ       0x0A  // varint，可选序号，用于重传去重
+#define ORDER_TLV_TAG_ITEM_ID   0x0B  // varint，按目录ID下单的菜品，每个菜品一个
+#define ORDER_TLV_TAG_MENU_VER  0x0C  // varint，菜单版本
+#define ORDER_TLV_TAG_MENU_PART 0x0D  // [分段序号 varint][分段总数 varint]
+#define ORDER_TLV_TAG_MENU_ITEM 0x0E  // [ID varint][工位 varint][分类 varint][菜名 UTF-8]，工位255表示未指定
+#define ORDER_TLV_TAG_ITEM_MODS 0x0F  // 字符串，作用于前一个菜品的备注
+#define ORDER_TLV_TAG_PRIORITY  0x10  // varint，0~255，越大越优先
+#define ORDER_TLV_TAG_DEADLINE  0x11  // varint，出餐期限（Unix秒）
+#define ORDER_TLV_TAG_ITEM_STATION 0x12  // varint，作用于前一个菜品的出品工位（含工位0），缺省为未指定
+
+/**
+ * @brief 解码一帧TLV消息到订单记录
+ *
+ * 未知标签被跳过，便于协议向后兼容地扩展。
+ *
+ * @return ESP_OK 解码成功
+ * @return ESP_ERR_INVALID_VERSION 版本不支持
+ * @return ESP_ERR_INVALID_SIZE 帧被截断或长度字段越界
+ * @return ESP_ERR_NOT_SUPPORTED 未知的消息类型
+ * @return ESP_ERR_INVALID_ARG 字符串值不是有效的UTF-8
+ */
+esp_err_t order_tlv_decode(const uint8_t *data, size_t len, order_record_t *rec);
+
+/**
+ * @brief 批量消息中单个操作的回调
+ *
+ * @param op 操作内容 [消息类型 u8][TLV]...
+ */
+typedef void (*order_tlv_op_cb_t)(const uint8_t *op, size_t op_len, void *ctx);
+
+/**
+ * @brief 遍历批量帧中的 OP 字段
+ *
+ * @param data 完整帧（含版本与消息类型）
+ */
+esp_err_t order_tlv_for_each_op(const uint8_t *data, size_t len, order_tlv_op_cb_t cb, void *ctx);
+
+/**
+ * @brief 解码批量中的单条操作（不含版本字节）
+ */
+esp_err_t order_tlv_decode_op(const uint8_t *op, size_t len, order_record_t *rec);
+
+#endif // ORDER_TLV_H
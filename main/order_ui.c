@@ -1,15 +1,24 @@
 #include "order_ui.h"
+#include "notify_outbox.h"
+#include "order_store.h"
+#include "order_journal.h"
+#include "ui_theme.h"
+#include "ui_perf.h"
+#include "utf8_validator.h"
 #include "font/lv_symbol_def.h"
 #include "lvgl.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "bsp/display.h"
 #include "bsp/esp-bsp.h"
 #include "font/fonts.h"
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
-#include "sys/queue.h"
-#include "cJSON.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 
 // 函数声明
 void init_time_update(void);
@@ -24,233 +33,823 @@ static lv_obj_t *status_bar = NULL;                // 状态栏
 static lv_obj_t *bluetooth_label = NULL;
 static lv_obj_t *time_label = NULL;
 static lv_obj_t *waiting_count_label = NULL;        // 等待订单数量显示
+static lv_obj_t *station_label = NULL;              // 当前显示的工位，点击切换
 
-// 订单数据结构
-typedef enum {
-    ORDER_STATUS_PENDING,      // 等待处理
-    ORDER_STATUS_PROCESSING,   // 处理中（当前焦点）
-    ORDER_STATUS_COMPLETED     // 已完成
-} order_status_t;
-
-typedef struct order_info {
-    char *order_id;
-    int order_num;
-    char *dishes;
-    order_status_t status;
-    lv_obj_t *ui_widget;       // UI控件
-    STAILQ_ENTRY(order_info) entries;
-} order_info_t;
-
-// 订单队列
-STAILQ_HEAD(order_list_head, order_info);
-static struct order_list_head order_list = STAILQ_HEAD_INITIALIZER(order_list);
-static order_info_t *current_processing_order = NULL;  // 当前处理的订单
+// 等待订单列表按需显示：只保留可见行加上下预留的行，滚动时循环复用。
+// 第 i 名订单固定由 waiting_rows[i % WAITING_ROW_POOL] 显示，滚动一行只需改写一行
+#define WAITING_ROW_HEIGHT      50
+#define WAITING_ROW_PITCH       55  // 行高加行间距
+#define WAITING_LIST_OVERSCAN   2   // 可见区域上下各预留的行数
+#define WAITING_ROW_POOL        (MAX_WAITING_ORDERS_DISPLAY + 2 * WAITING_LIST_OVERSCAN)
+
+typedef struct {
+    lv_obj_t *item;
+    lv_obj_t *num_label;
+    lv_obj_t *dish_label;
+    lv_obj_t *status_label;
+    int index;                  // 显示的名次，-1 表示未使用
+    bool urgent;                // 状态文字当前是否为加急颜色
+} waiting_row_t;
+
+// 网格模式下等待列表从网格之后的名次开始
+#ifdef CONFIG_KDS_UI_GRID_MODE
+#define UI_GRID_MODE            1
+#else
+#define UI_GRID_MODE            0
+#endif
+
+// 启动时实测订单卡片与菜品卡片样式的堆占用（调试用）
+#ifdef CONFIG_KDS_UI_COST_LOG
+#define UI_COST_LOG             1
+#else
+#define UI_COST_LOG             0
+#endif
+
+#define TICKET_GRID_COLS        2
+#define TICKET_GRID_ROWS        3
+#define TICKET_GRID_SIZE        (TICKET_GRID_COLS * TICKET_GRID_ROWS)
+#define WAITING_RANK_BASE       (UI_GRID_MODE ? TICKET_GRID_SIZE - 1 : 0)
+
+static waiting_row_t waiting_rows[WAITING_ROW_POOL];
+static lv_obj_t *waiting_list = NULL;               // 可滚动的等待订单列表
+static lv_obj_t *waiting_spacer = NULL;             // 撑开列表的滚动高度（订单数 x 行距）
+static lv_obj_t *waiting_hint_label = NULL;         // 暂无等待订单
+static int waiting_first = 0;                       // 当前绑定的第一个名次
+
+// 订单保存在 order_store 中，按订单ID索引；每个工位有自己的等待队列与焦点订单
+static uint8_t current_station = 0;                    // 当前显示的工位
+static order_info_t *current_processing_order = NULL;  // 当前工位已显示的焦点订单
+static bool focus_stale = false;                       // 已显示的焦点订单被移除，需要重新显示
+
+// 当前订单卡片初始化时一次创建，换订单时只改写文字与显隐
+static lv_obj_t *order_card = NULL;
+static lv_obj_t *order_title_label = NULL;
+static lv_obj_t *order_dishes = NULL;                // 菜品卡片容器
+static lv_obj_t *order_hint_label = NULL;            // 没有焦点订单时显示
+
+// 菜品卡片池：第 i 张卡片对应 items[i]，不足时按需补建，多余的隐藏
+typedef struct {
+    lv_obj_t *card;
+    lv_obj_t *name_label;
+    lv_obj_t *mods_label;
+    bool has_mods;              // 卡片当前是否按有备注布局
+} dish_slot_t;
+
+#define DISH_SLOT_PRESET        16  // 初始化时预建的菜品卡片数
+
+static dish_slot_t dish_slots[ORDER_MAX_ITEMS];
+static int dish_slot_count = 0;
+static order_info_t *displayed_order = NULL;         // 卡片当前绑定的订单，卡片隐藏时置空
+
+// 网格模式：第0格为工位的焦点订单，其后依次为等待队列的前几名；格子固定，换单只改写文字
+typedef struct {
+    lv_obj_t *card;
+    lv_obj_t *title_label;
+    lv_obj_t *dishes_label;
+    lv_obj_t *mods_label;
+    order_info_t *order;        // 绑定的订单，NULL 表示空格
+} ticket_cell_t;
+
+static ticket_cell_t ticket_cells[TICKET_GRID_SIZE];
+static lv_obj_t *ticket_grid = NULL;
 
 static bool is_bluetooth_connected = false;
 
-// 按钮点击回调 - 完成当前订单
+// UI事件队列与任务
+#define UI_EVENT_QUEUE_LEN      16
+#define UI_TASK_STACK_SIZE      6144
+#define UI_TASK_PRIORITY        3
+
+#define UI_BATCH_WAIT_MS        200   // 批量中等待下一条事件的最长时间
+
+static QueueHandle_t ui_event_queue = NULL;
+static TaskHandle_t ui_event_task = NULL;
+
+// 批量应用期间只更新订单队列，结束时统一刷新一次界面
+static bool render_deferred = false;
+
+// 订单操作的处理耗时，仅UI任务写
+static uint32_t single_ops = 0;
+static uint32_t single_us_total = 0;
+static uint32_t single_us_max = 0;
+static uint32_t batch_count = 0;
+static uint32_t batch_ops_total = 0;
+static uint32_t batch_ops_max = 0;
+static uint32_t batch_us_total = 0;
+static uint32_t batch_us_max = 0;
+
+static void start_ui_event_task(void);
+static void show_waiting_hint(void);
+static void render_orders(void);
+static void show_current_order(order_info_t *order);
+static void update_waiting_orders_display(void);
+
+// 批量应用期间不逐条弹窗
+static void ui_popup(const char *message, uint32_t duration_ms)
+{
+    if (!render_deferred) {
+        show_popup_message(message, duration_ms);
+    }
+}
+
+// 文本不变时不调用 lv_label_set_text，避免重新排版与重绘
+static void label_set_text_if_changed(lv_obj_t *label, const char *text)
+{
+    if (strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
+    }
+}
+
+static void obj_set_hidden(lv_obj_t *obj, bool hidden)
+{
+    if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) != hidden) {
+        if (hidden) {
+            lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
+
+static inline const char *dish_name(const order_info_t *order, const order_dish_t *dish)
+{
+    return order->text + dish->name_off;
+}
+
+static inline const char *dish_mods(const order_info_t *order, const order_dish_t *dish)
+{
+    return order->text + dish->mods_off;
+}
+
+// 菜品卡片上的文字："名称" 或 "名称xN"
+static void format_dish(const order_info_t *order, const order_dish_t *dish, char *buf, size_t size)
+{
+    if (dish->qty > 1) {
+        snprintf(buf, size, "%.*sx%u", dish->name_len, dish_name(order, dish), dish->qty);
+    } else {
+        snprintf(buf, size, "%.*s", dish->name_len, dish_name(order, dish));
+    }
+}
+
+// 等待列表的一行摘要，只列出当前工位的菜品
+static const char *format_summary(const order_info_t *order)
+{
+    static char summary[256];
+    size_t len = 0;
+
+    if (order->item_count == 0) {
+        return "无菜品";
+    }
+
+    summary[0] = '\0';
+    for (int i = 0; i < order->item_count && len < sizeof(summary) - 1; i++) {
+        if (order->items[i].station != current_station) {
+            continue;
+        }
+        if (len > 0) {
+            len += snprintf(summary + len, sizeof(summary) - len, "、");
+            if (len >= sizeof(summary) - 1) break;
+        }
+        format_dish(order, &order->items[i], summary + len, sizeof(summary) - len);
+        len += strlen(summary + len);
+    }
+    // 超长时按字节截断，去掉末尾的半个字符
+    summary[utf8_trim_len((const uint8_t *)summary, strlen(summary))] = '\0';
+    return summary;
+}
+
+static int dish_find(const order_info_t *order, const char *name, size_t len)
+{
+    for (int i = 0; i < order->item_count; i++) {
+        const order_dish_t *dish = &order->items[i];
+        if (dish->name_len == len && memcmp(dish_name(order, dish), name, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 删除菜品，名称留在 text 区域直到下次整单加载
+static void dish_remove(order_info_t *order, int idx)
+{
+    memmove(&order->items[idx], &order->items[idx + 1], (order->item_count - idx - 1) * sizeof(order_dish_t));
+    order->item_count--;
+}
+
+// 菜品数组替换为记录中的菜品，数组与文本区各一次分配
+static void order_load_record(order_info_t *order, const order_record_t *rec)
+{
+    size_t text = 0;
+    for (int i = 0; i < rec->item_count; i++) {
+        text += rec->items[i].name_len + 1 + (rec->items[i].mods_len ? rec->items[i].mods_len + 1 : 0);
+    }
+
+    order->item_count = 0;
+    order->text_len = 0;
+    if (!order_store_reserve_dishes(order, rec->item_count, text)) {
+        ESP_LOGE(TAG, "菜品内存分配失败");
+        return;
+    }
+    for (int i = 0; i < rec->item_count; i++) {
+        const order_item_t *item = &rec->items[i];
+        order_store_append_dish(order, order_record_item_name(rec, i), item->name_len, item->qty,
+                    order_record_item_mods(rec, i), item->mods_len, item->station);
+    }
+}
+
+// 整单更新前按增量编辑的规则重新打开工位：新增菜品、换了工位或数量增加的菜品所在工位的子单重新打开
+static void reopen_grown_stations(order_info_t *order, const order_record_t *rec)
+{
+    for (int i = 0; i < rec->item_count; i++) {
+        const order_item_t *item = &rec->items[i];
+        if (item->qty == 0) {
+            continue;
+        }
+        int idx = dish_find(order, order_record_item_name(rec, i), item->name_len);
+        if (idx < 0 || order->items[idx].station != item->station || item->qty > order->items[idx].qty) {
+            order->done &= ~(1u << item->station);
+        }
+    }
+}
+
+// 兼容旧接口的整单更新：菜品都在工位0，出现新菜名时重新打开工位0
+static void reopen_for_string(order_info_t *order, const char *dishes)
+{
+    const char *p = dishes;
+    while (*p) {
+        const char *sep = strstr(p, "、");
+        size_t len = sep ? (size_t)(sep - p) : strlen(p);
+        int idx = len > 0 ? dish_find(order, p, len) : 0;
+        if (idx < 0 || (len > 0 && order->items[idx].station != 0)) {
+            order->done &= ~1u;
+            return;
+        }
+        p += len;
+        if (sep) {
+            p += strlen("、");
+        }
+    }
+}
+
+// 兼容旧接口：菜品数组替换为"、"分隔字符串中的菜品（只在加入时拆分一次）
+static void order_load_string(order_info_t *order, const char *dishes)
+{
+    order->item_count = 0;
+    order->text_len = 0;
+    const char *p = dishes;
+    while (*p) {
+        const char *sep = strstr(p, "、");
+        size_t len = sep ? (size_t)(sep - p) : strlen(p);
+        if (len > 0 && !order_store_append_dish(order, p, len, 1, NULL, 0, 0)) {
+            ESP_LOGE(TAG, "菜品内存分配失败");
+            break;
+        }
+        p += len;
+        if (sep) {
+            p += strlen("、");
+        }
+    }
+}
+
+// 同一订单ID只保留一张卡片，已存在时返回NULL
+static order_info_t *order_new(const char *order_id, int order_num)
+{
+    order_info_t *order;
+    esp_err_t ret = order_store_add(order_id, order_num, &order);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        ESP_LOGW(TAG, "订单已存在，忽略重复添加: %s", order_id);
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "添加订单失败: %s (%s)", order_id, esp_err_to_name(ret));
+    }
+    return ret == ESP_OK ? order : NULL;
+}
+
+static void order_free(order_info_t *order)
+{
+    if (order == current_processing_order) {
+        current_processing_order = NULL;
+        focus_stale = true;
+    }
+    if (order == displayed_order) {
+        displayed_order = NULL;
+    }
+    order_journal_remove(order->order_id);
+    order_store_remove(order);
+}
+
+// 没有焦点订单的工位从各自的队列取下一个
+static void advance_stations(void)
+{
+    for (int st = 0; st < ORDER_STATION_MAX; st++) {
+        if (!order_store_focus(st)) {
+            order_store_start_next(st);
+        }
+    }
+}
+
+// 各工位补上焦点订单；当前工位的焦点变化时重新显示，返回是否变化
+static bool sync_focus(void)
+{
+    advance_stations();
+
+    order_info_t *focus = order_store_focus(current_station);
+    if (focus == current_processing_order && !focus_stale) {
+        return false;
+    }
+    current_processing_order = focus;
+    focus_stale = false;
+    if (!render_deferred) {
+        if (focus) {
+            show_current_order(focus);
+        } else {
+            show_waiting_hint();
+        }
+    }
+    return true;
+}
+
+// 菜品变化后重新分配工位；剩余菜品所在的工位都已出餐时整单完成，返回订单是否已移除
+static bool reroute_order(order_info_t *order)
+{
+    order_store_route(order);
+    if (order_store_open_stations(order) == 0) {
+        ESP_LOGI(TAG, "订单各工位均已出餐: %s", order->order_id);
+        notify_outbox_post_completion(order->order_id);
+        order_free(order);
+        return true;
+    }
+    order_journal_upsert(order);
+    return false;
+}
+
+// 工位出餐：各工位分别确认，全部出餐后整单确认并移除
+static void complete_station_order(order_info_t *order, uint8_t station)
+{
+    ESP_LOGI(TAG, "工位 %u 出餐: %s", station, order->order_id);
+    
+    // 完成确认交给发件箱，拥塞或断线时由其合并重发
+    if (order_store_complete_station(order, station)) {
+        notify_outbox_post_completion(order->order_id);
+        order_free(order);
+    } else {
+        notify_outbox_post_station(order->order_id, station);
+        order_journal_upsert(order);
+    }
+    
+    if (sync_focus() && current_processing_order) {
+        ui_popup("开始处理下一个订单", 2000);
+    }
+    if (!render_deferred) {
+        update_waiting_orders_display();
+    }
+}
+
+// 按钮点击回调 - 当前工位出餐
 static void btn_complete_cb(lv_event_t *e)
 {
     bsp_display_lock(portMAX_DELAY);
     
     if (current_processing_order) {
-        // 发送完成通知 - 使用压缩格式
-        char notify_msg[128];
-        snprintf(notify_msg, sizeof(notify_msg), 
-                "{\"o\":\"%s\",\"s\":true}", 
-                current_processing_order->order_id);
-        
-        send_notification(notify_msg);
-        ESP_LOGI(TAG, "订单完成: %s", current_processing_order->order_id);
-        
-        // 保存订单ID用于后续处理
-        char *completed_order_id = strdup(current_processing_order->order_id);
-        
-        // 标记为已完成并从UI移除
-        current_processing_order->status = ORDER_STATUS_COMPLETED;
-        if (current_processing_order->ui_widget && lv_obj_is_valid(current_processing_order->ui_widget)) {
-            lv_obj_del(current_processing_order->ui_widget);
-            current_processing_order->ui_widget = NULL;
-        }
-        
-        // 切换到下一个订单
-        complete_current_order(completed_order_id);
-        free(completed_order_id);
+        complete_station_order(current_processing_order, current_station);
     }
     
     bsp_display_unlock();
 }
 
-// 创建当前订单显示区域
-static void create_current_order_display(order_info_t *order)
+// 创建一张菜品卡片加入池中，之后只改写文字与显隐
+static void create_dish_slot(dish_slot_t *slot)
 {
-    if (!current_order_container || !order) return;
+    slot->card = lv_obj_create(order_dishes);
+    // 自适应宽度，无备注时固定高度
+    lv_obj_set_size(slot->card, LV_SIZE_CONTENT, 39);
+    ui_theme_apply(slot->card, UI_STYLE_DISH_CHIP);
+    // 备注（如"少辣、加蛋"）显示在菜名下方，无备注时菜名垂直居中
+    lv_obj_set_flex_flow(slot->card, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(slot->card, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
+    lv_obj_add_flag(slot->card, LV_OBJ_FLAG_HIDDEN);
+    
+    // 菜名的字体与颜色继承自卡片样式
+    slot->name_label = lv_label_create(slot->card);
+    lv_label_set_text(slot->name_label, "");
+    
+    slot->mods_label = lv_label_create(slot->card);
+    lv_label_set_text(slot->mods_label, "");
+    ui_theme_apply(slot->mods_label, UI_STYLE_DISH_MODS);
+    lv_obj_add_flag(slot->mods_label, LV_OBJ_FLAG_HIDDEN);
+    slot->has_mods = false;
+}
+
+// 把 items[idx] 绑定到第 idx 张菜品卡片，其他工位的菜品隐藏
+static void bind_dish_slot(const order_info_t *order, int idx)
+{
+    if (idx >= ORDER_MAX_ITEMS) {
+        ESP_LOGW(TAG, "菜品数超过卡片上限，第 %d 个菜品不显示", idx + 1);
+        return;
+    }
+    while (dish_slot_count <= idx) {
+        create_dish_slot(&dish_slots[dish_slot_count++]);
+    }
     
-    // 清空当前容器
-    lv_obj_clean(current_order_container);
+    dish_slot_t *slot = &dish_slots[idx];
+    const order_dish_t *dish = &order->items[idx];
+    char text[160];
+    format_dish(order, dish, text, sizeof(text));
+    label_set_text_if_changed(slot->name_label, text);
     
-    // 创建订单卡片
-    lv_obj_t *order_card = lv_obj_create(current_order_container);
+    bool has_mods = dish->mods_len != 0;
+    if (has_mods) {
+        label_set_text_if_changed(slot->mods_label, dish_mods(order, dish));
+    }
+    if (has_mods != slot->has_mods) {
+        lv_obj_set_height(slot->card, has_mods ? LV_SIZE_CONTENT : 39);
+        obj_set_hidden(slot->mods_label, !has_mods);
+        slot->has_mods = has_mods;
+    }
+    obj_set_hidden(slot->card, dish->station != current_station);
+}
+
+// 从第 from 个菜品起重新绑定卡片，多出的卡片隐藏
+static void bind_dishes(const order_info_t *order, int from)
+{
+    for (int i = from; i < order->item_count; i++) {
+        bind_dish_slot(order, i);
+    }
+    for (int i = order->item_count; i < dish_slot_count; i++) {
+        obj_set_hidden(dish_slots[i].card, true);
+    }
+}
+
+// 创建当前订单卡片与预建的菜品卡片，初始隐藏
+static void create_order_card(void)
+{
+    order_card = lv_obj_create(current_order_container);
     lv_obj_set_size(order_card, LV_PCT(95), 500);  // 大尺寸，突出显示
-    lv_obj_set_style_bg_color(order_card, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_border_color(order_card, lv_color_hex(0x08C160), 0);
-    lv_obj_set_style_border_width(order_card, 3, 0);
+    ui_theme_apply(order_card, UI_STYLE_ORDER_CARD);
     // lv_obj_set_style_radius(order_card, 10, 0);
     // lv_obj_set_style_shadow_width(order_card, 20, 0);
     // lv_obj_set_style_shadow_color(order_card, lv_color_hex(0x000000), 0);
     // lv_obj_set_style_shadow_opa(order_card, LV_OPA_30, 0);
     lv_obj_center(order_card);
+    lv_obj_add_flag(order_card, LV_OBJ_FLAG_HIDDEN);
     
     // 订单号标题
-    lv_obj_t *title_label = lv_label_create(order_card);
-    char title_text[32];
-    snprintf(title_text, sizeof(title_text), "订单 #%d", order->order_num);
-    lv_label_set_text(title_label, title_text);
-    set_font_style(title_label, FONT_TYPE_DEVICE, FONT_SIZE_LARGE);
-    lv_obj_set_style_text_color(title_label, lv_color_hex(0x08C160), 0);
-    lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 15);
+    order_title_label = lv_label_create(order_card);
+    lv_label_set_text(order_title_label, "");
+    ui_theme_apply(order_title_label, UI_STYLE_ORDER_TITLE);
+    lv_obj_align(order_title_label, LV_ALIGN_TOP_MID, 0, 15);
     
     // 菜品显示区域 - 优化布局
-    lv_obj_t *dishes_container = lv_obj_create(order_card);
-    lv_obj_set_size(dishes_container, LV_PCT(90), LV_SIZE_CONTENT);
-    lv_obj_set_flex_flow(dishes_container, LV_FLEX_FLOW_ROW_WRAP);
-    lv_obj_set_flex_align(dishes_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
-    lv_obj_set_style_pad_gap(dishes_container, 10, 0);
-    lv_obj_set_style_pad_all(dishes_container, 10, 0);
-    lv_obj_set_style_border_width(dishes_container, 0, 0); // 移除边框
-    lv_obj_set_style_bg_color(dishes_container, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_align(dishes_container, LV_ALIGN_TOP_MID, 0, 60);
-    
-    // 解析并显示菜品 - 支持字符串格式（已解码的中文菜品名称）
-    ESP_LOGI(TAG, "解析菜品数据: %s", order->dishes);
-    
-    // 菜品数据已经是解码后的中文字符串，如"陈醋、沙棘、黄花"
-    // 按"、"分隔符分割菜品
-    char *dishes_copy = strdup(order->dishes);
-    if (!dishes_copy) {
-        ESP_LOGE(TAG, "内存分配失败");
-        return;
-    }
-    
-    char *token = strtok(dishes_copy, "、");
-    int displayed_count = 0;
-    
-    while (token != NULL) {
-        ESP_LOGI(TAG, "显示菜品: %s", token);
-        
-        // 创建菜品卡片 - 借鉴旧版本设计
-        lv_obj_t *dish_card = lv_obj_create(dishes_container);
-        lv_obj_set_size(dish_card, LV_SIZE_CONTENT, 39); // 自适应宽度，固定高度
-        lv_obj_set_style_bg_color(dish_card, lv_color_hex(0xF1F1F1), 0); // 灰色背景 #F1F1F1
-        lv_obj_set_style_radius(dish_card, 5, 0); // 圆角5px
-        lv_obj_set_style_pad_all(dish_card, 8, 0); // 内边距8px
-        lv_obj_set_style_border_width(dish_card, 0, 0); // 无边框
-        lv_obj_set_style_margin_all(dish_card, 5, 0); // 设置卡片间距
-        
-        lv_obj_t *dish_label = lv_label_create(dish_card);
-        lv_obj_set_style_text_color(dish_label, lv_color_hex(0x333333), 0);
-        lv_label_set_text(dish_label, token);
-        set_font_style(dish_label, FONT_TYPE_DISHES, FONT_SIZE_LARGE);
-        lv_obj_center(dish_label);
-        
-        displayed_count++;
-        token = strtok(NULL, "、");
+    order_dishes = lv_obj_create(order_card);
+    lv_obj_set_size(order_dishes, LV_PCT(90), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(order_dishes, LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_flex_align(order_dishes, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
+    ui_theme_apply(order_dishes, UI_STYLE_DISH_LIST);
+    lv_obj_align(order_dishes, LV_ALIGN_TOP_MID, 0, 60);
+    
+    while (dish_slot_count < DISH_SLOT_PRESET) {
+        create_dish_slot(&dish_slots[dish_slot_count++]);
     }
     
-    free(dishes_copy);
-    ESP_LOGI(TAG, "成功显示 %d 个菜品", displayed_count);
-    
     // 完成按钮
     lv_obj_t *complete_btn = lv_btn_create(order_card);
     // lv_obj_set_size(complete_btn, 200, 60);
     lv_obj_set_size(complete_btn, LV_PCT(90), 100);
-    lv_obj_set_style_bg_color(complete_btn, lv_color_hex(0x08C160), 0);
-    lv_obj_set_style_radius(complete_btn, 8, 0);
+    ui_theme_apply(complete_btn, UI_STYLE_COMPLETE_BTN);
     lv_obj_align(complete_btn, LV_ALIGN_BOTTOM_MID, 0, -20);
     
     lv_obj_t *btn_label = lv_label_create(complete_btn);
     lv_label_set_text(btn_label, "出餐完成");
-    set_font_style(btn_label, FONT_TYPE_DEVICE, FONT_SIZE_LARGE);
-    lv_obj_set_style_text_color(btn_label, lv_color_white(), 0);
     lv_obj_center(btn_label);
     
     lv_obj_add_event_cb(complete_btn, btn_complete_cb, LV_EVENT_CLICKED, NULL);
+}
+
+// 点击小票：该订单在当前工位出餐，其余小票依次前移
+static void ticket_click_cb(lv_event_t *e)
+{
+    ticket_cell_t *cell = lv_event_get_user_data(e);
     
-    order->ui_widget = order_card;
+    bsp_display_lock(portMAX_DELAY);
+    if (cell->order) {
+        ui_perf_begin(UI_PERF_TICKET_BUMP);
+        complete_station_order(cell->order, current_station);
+        ui_perf_end(UI_PERF_TICKET_BUMP);
+    }
+    bsp_display_unlock();
 }
 
-// 更新等待订单显示
-static void update_waiting_orders_display(void)
+// 创建 2x3 小票网格，每格一张可复用的小票，初始隐藏
+static void create_ticket_grid(void)
+{
+    static const int32_t col_dsc[] = { LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST };
+    static const int32_t row_dsc[] = { LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST };
+    _Static_assert(sizeof(col_dsc) / sizeof(col_dsc[0]) == TICKET_GRID_COLS + 1, "网格列数");
+    _Static_assert(sizeof(row_dsc) / sizeof(row_dsc[0]) == TICKET_GRID_ROWS + 1, "网格行数");
+    
+    ticket_grid = lv_obj_create(current_order_container);
+    lv_obj_set_size(ticket_grid, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_grid_dsc_array(ticket_grid, col_dsc, row_dsc);
+    ui_theme_apply(ticket_grid, UI_STYLE_TICKET_GRID);
+    lv_obj_clear_flag(ticket_grid, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(ticket_grid, LV_OBJ_FLAG_HIDDEN);
+    
+    for (int i = 0; i < TICKET_GRID_SIZE; i++) {
+        ticket_cell_t *cell = &ticket_cells[i];
+        
+        cell->card = lv_obj_create(ticket_grid);
+        lv_obj_set_grid_cell(cell->card, LV_GRID_ALIGN_STRETCH, i % TICKET_GRID_COLS, 1,
+                             LV_GRID_ALIGN_STRETCH, i / TICKET_GRID_COLS, 1);
+        ui_theme_apply(cell->card, UI_STYLE_TICKET);
+        if (i == 0) {
+            // 第0格为焦点订单，沿用当前订单卡片的绿框
+            ui_theme_apply(cell->card, UI_STYLE_ORDER_CARD);
+        }
+        lv_obj_set_flex_flow(cell->card, LV_FLEX_FLOW_COLUMN);
+        lv_obj_clear_flag(cell->card, LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_add_flag(cell->card, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_event_cb(cell->card, ticket_click_cb, LV_EVENT_CLICKED, cell);
+        
+        cell->title_label = lv_label_create(cell->card);
+        lv_label_set_text(cell->title_label, "");
+        ui_theme_apply(cell->title_label, UI_STYLE_ORDER_TITLE);
+        
+        // 菜品逐行显示，超出小票的部分裁掉
+        cell->dishes_label = lv_label_create(cell->card);
+        lv_label_set_text(cell->dishes_label, "");
+        lv_obj_set_width(cell->dishes_label, LV_PCT(100));
+        lv_obj_set_flex_grow(cell->dishes_label, 1);
+        lv_label_set_long_mode(cell->dishes_label, LV_LABEL_LONG_CLIP);
+        ui_theme_apply(cell->dishes_label, UI_STYLE_DISH_TEXT);
+        
+        cell->mods_label = lv_label_create(cell->card);
+        lv_label_set_text(cell->mods_label, "");
+        lv_obj_set_width(cell->mods_label, LV_PCT(100));
+        ui_theme_apply(cell->mods_label, UI_STYLE_DISH_MODS);
+        lv_obj_add_flag(cell->mods_label, LV_OBJ_FLAG_HIDDEN);
+        cell->order = NULL;
+    }
+}
+
+// 小票上的文字：当前工位的菜品每行一个，备注以 "菜名: 备注" 逐行列出
+static void format_ticket(const order_info_t *order, char *dishes, size_t dishes_size,
+                          char *mods, size_t mods_size)
 {
-    if (!waiting_orders_container) return;
+    size_t dlen = 0;
+    size_t mlen = 0;
+    dishes[0] = '\0';
+    mods[0] = '\0';
+    
+    for (int i = 0; i < order->item_count; i++) {
+        const order_dish_t *dish = &order->items[i];
+        if (dish->station != current_station) {
+            continue;
+        }
+        if (dlen + 1 < dishes_size) {
+            if (dlen > 0) {
+                dishes[dlen++] = '\n';
+            }
+            format_dish(order, dish, dishes + dlen, dishes_size - dlen);
+            dlen += strlen(dishes + dlen);
+        }
+        if (dish->mods_len && mlen + 1 < mods_size) {
+            mlen += snprintf(mods + mlen, mods_size - mlen, "%s%.*s: %s", mlen ? "\n" : "",
+                             dish->name_len, dish_name(order, dish), dish_mods(order, dish));
+            if (mlen >= mods_size) {
+                mlen = mods_size - 1;
+            }
+        }
+    }
+    // 超长时按字节截断，去掉末尾的半个字符
+    dishes[utf8_trim_len((const uint8_t *)dishes, strlen(dishes))] = '\0';
+    mods[utf8_trim_len((const uint8_t *)mods, mlen)] = '\0';
+}
+
+// 把订单绑定到一格小票，order 为NULL时隐藏；文字不变的小票不重绘
+static void bind_ticket(ticket_cell_t *cell, order_info_t *order)
+{
+    cell->order = order;
+    if (!order) {
+        obj_set_hidden(cell->card, true);
+        return;
+    }
+    
+    char title_text[32];
+    char dishes[256];
+    char mods[256];
+    snprintf(title_text, sizeof(title_text), "#%d", order->order_num);
+    format_ticket(order, dishes, sizeof(dishes), mods, sizeof(mods));
+    label_set_text_if_changed(cell->title_label, title_text);
+    label_set_text_if_changed(cell->dishes_label, dishes);
+    label_set_text_if_changed(cell->mods_label, mods);
+    obj_set_hidden(cell->mods_label, mods[0] == '\0');
+    obj_set_hidden(cell->card, false);
+}
+
+// 第1格起按名次绑定等待队列的前几名；完成一张小票时后面的小票只改写文字
+static void bind_waiting_tickets(void)
+{
+    order_info_t *orders[TICKET_GRID_SIZE - 1];
+    int n = order_store_pending_range(current_station, 0, orders, TICKET_GRID_SIZE - 1);
+    for (int i = 1; i < TICKET_GRID_SIZE; i++) {
+        bind_ticket(&ticket_cells[i], i - 1 < n ? orders[i - 1] : NULL);
+    }
+}
+
+// 把订单绑定到当前订单卡片：只改写变化的文字，不创建或删除对象（菜品数超过已建卡片时除外）
+static void show_current_order(order_info_t *order)
+{
+    if (!order) return;
+    
+    if (UI_GRID_MODE) {
+        bind_ticket(&ticket_cells[0], order);
+        obj_set_hidden(order_hint_label, true);
+        obj_set_hidden(ticket_grid, false);
+        displayed_order = order;
+        return;
+    }
     
-    // 清空等待容器
-    lv_obj_clean(waiting_orders_container);
+    char title_text[32];
+    snprintf(title_text, sizeof(title_text), "订单 #%d", order->order_num);
+    label_set_text_if_changed(order_title_label, title_text);
     
-    // 计算等待订单数量
-    int waiting_count = 0;
-    order_info_t *order;
-    STAILQ_FOREACH(order, &order_list, entries) {
-        if (order->status == ORDER_STATUS_PENDING) {
-            waiting_count++;
+    // 每个菜品一张卡片，顺序与菜品数组一致，增量编辑按下标修补
+    bind_dishes(order, 0);
+    ESP_LOGI(TAG, "成功显示 %d 个菜品", order->item_count);
+    
+    obj_set_hidden(order_hint_label, true);
+    obj_set_hidden(order_card, false);
+    displayed_order = order;
+}
+
+static void waiting_list_scroll_cb(lv_event_t *e);
+
+// 创建可滚动的等待订单列表与固定数量的行，之后只改写文字、位置与显隐
+static void create_waiting_list(void)
+{
+    waiting_list = lv_obj_create(waiting_orders_container);
+    lv_obj_set_width(waiting_list, LV_PCT(100));
+    lv_obj_set_flex_grow(waiting_list, 1);
+    ui_theme_apply(waiting_list, UI_STYLE_WAITING_LIST);
+    lv_obj_set_scroll_dir(waiting_list, LV_DIR_VER);
+    lv_obj_add_event_cb(waiting_list, waiting_list_scroll_cb, LV_EVENT_SCROLL, NULL);
+    
+    // 行按名次绝对定位，滚动范围由占位对象撑开
+    waiting_spacer = lv_obj_create(waiting_list);
+    lv_obj_set_size(waiting_spacer, 1, 0);
+    ui_theme_apply(waiting_spacer, UI_STYLE_PLAIN);
+    lv_obj_clear_flag(waiting_spacer, LV_OBJ_FLAG_CLICKABLE);
+    
+    for (int r = 0; r < WAITING_ROW_POOL; r++) {
+        waiting_row_t *row = &waiting_rows[r];
+        
+        // 创建等待订单项
+        row->item = lv_obj_create(waiting_list);
+        lv_obj_set_size(row->item, LV_PCT(100), WAITING_ROW_HEIGHT);
+        ui_theme_apply(row->item, UI_STYLE_WAITING_ROW);
+        lv_obj_add_flag(row->item, LV_OBJ_FLAG_HIDDEN);
+        
+        // 订单号显示
+        row->num_label = lv_label_create(row->item);
+        lv_label_set_text(row->num_label, "");
+        ui_theme_apply(row->num_label, UI_STYLE_ROW_NUM);
+        lv_obj_align(row->num_label, LV_ALIGN_LEFT_MID, 10, 0);
+        
+        // 菜品名称显示
+        row->dish_label = lv_label_create(row->item);
+        lv_label_set_text(row->dish_label, "");
+        ui_theme_apply(row->dish_label, UI_STYLE_ROW_DISHES);
+        lv_obj_align(row->dish_label, LV_ALIGN_LEFT_MID, 100, 0);
+        
+        // 状态指示
+        row->status_label = lv_label_create(row->item);
+        lv_label_set_text(row->status_label, "等待中");
+        ui_theme_apply(row->status_label, UI_STYLE_ROW_STATUS);
+        lv_obj_align(row->status_label, LV_ALIGN_RIGHT_MID, -10, 0);
+        row->index = -1;
+        row->urgent = false;
+    }
+    
+    // 如果没有等待订单，显示提示
+    waiting_hint_label = lv_label_create(waiting_list);
+    lv_label_set_text(waiting_hint_label, "暂无等待订单");
+    ui_theme_apply(waiting_hint_label, UI_STYLE_WAITING_HINT);
+}
+
+// 滚动位置对应的第一个绑定名次（含上方预留行）
+static int waiting_window_first(void)
+{
+    int first = lv_obj_get_scroll_y(waiting_list) / WAITING_ROW_PITCH - WAITING_LIST_OVERSCAN;
+    return first > 0 ? first : 0;
+}
+
+// 把名次 [first, first + WAITING_ROW_POOL) 的订单绑定到对应的行；
+// force 为 false 时名次未变的行保持不动，为 true 时按订单重新比较文字
+static void bind_waiting_window(int first, bool force)
+{
+    order_info_t *orders[WAITING_ROW_POOL];
+    int n = order_store_pending_range(current_station, WAITING_RANK_BASE + first, orders, WAITING_ROW_POOL);
+    waiting_first = first;
+    
+    for (int k = 0; k < WAITING_ROW_POOL; k++) {
+        int index = first + k;
+        waiting_row_t *row = &waiting_rows[index % WAITING_ROW_POOL];
+        if (k >= n) {
+            row->index = -1;
+            obj_set_hidden(row->item, true);
+            continue;
+        }
+        if (row->index == index && !force) {
+            continue;
+        }
+        
+        const order_info_t *order = orders[k];
+        char order_text[20];
+        snprintf(order_text, sizeof(order_text), "#%d", order->order_num);
+        label_set_text_if_changed(row->num_label, order_text);
+        label_set_text_if_changed(row->dish_label, format_summary(order));
+        
+        bool urgent = order->priority > 0;
+        if (urgent != row->urgent) {
+            ui_theme_toggle(row->status_label, UI_STYLE_URGENT, urgent);
+            row->urgent = urgent;
+        }
+        if (row->index != index) {
+            lv_obj_set_y(row->item, index * WAITING_ROW_PITCH);
+            row->index = index;
         }
+        obj_set_hidden(row->item, false);
     }
+}
+
+// 滚动时只绑定新进入预留区域的行，订单数据按名次从订单存储读取
+static void waiting_list_scroll_cb(lv_event_t *e)
+{
+    bsp_display_lock(portMAX_DELAY);
+    int first = waiting_window_first();
+    if (first != waiting_first) {
+        bind_waiting_window(first, false);
+    }
+    bsp_display_unlock();
+}
+
+// 更新等待订单显示：行控件固定，只改写变化的文字、颜色与显隐，稳定状态下不创建对象
+static void update_waiting_orders_display(void)
+{
+    if (!waiting_list) return;
+    
+    ui_perf_begin(UI_PERF_WAITING_LIST);
+    int waiting_count = order_store_pending_count(current_station);
     
     // 更新等待数量显示
     if (waiting_count_label) {
         char count_text[32];
         snprintf(count_text, sizeof(count_text), "等待订单: %d", waiting_count);
-        lv_label_set_text(waiting_count_label, count_text);
-    }
-    
-    // 显示前几个等待订单的缩略信息
-    int display_count = 0;
-    STAILQ_FOREACH(order, &order_list, entries) {
-        if (order->status == ORDER_STATUS_PENDING && display_count < MAX_WAITING_ORDERS_DISPLAY) {
-            // 创建等待订单项
-            lv_obj_t *waiting_item = lv_obj_create(waiting_orders_container);
-            lv_obj_set_size(waiting_item, LV_PCT(100), 50);
-            lv_obj_set_style_bg_color(waiting_item, lv_color_hex(0xF8F9FA), 0);
-            lv_obj_set_style_border_width(waiting_item, 1, 0);
-            lv_obj_set_style_border_color(waiting_item, lv_color_hex(0xDDDDDD), 0);
-            lv_obj_set_style_radius(waiting_item, 5, 0);
-            
-            // 订单号显示
-            lv_obj_t *order_label = lv_label_create(waiting_item);
-            char order_text[20];
-            snprintf(order_text, sizeof(order_text), "#%d", order->order_num);
-            lv_label_set_text(order_label, order_text);
-            set_font_style(order_label, FONT_TYPE_DEVICE, FONT_SIZE_MEDIUM);
-            lv_obj_align(order_label, LV_ALIGN_LEFT_MID, 10, 0);
-            
-            // 菜品名称显示
-            if (order->dishes && strlen(order->dishes) > 0) {
-                lv_obj_t *dish_label = lv_label_create(waiting_item);
-                lv_label_set_text(dish_label, order->dishes);
-                set_font_style(dish_label, FONT_TYPE_PUHUI, FONT_SIZE_MEDIUM);
-                lv_obj_set_style_text_color(dish_label, lv_color_hex(0x666666), 0);
-                lv_obj_align(dish_label, LV_ALIGN_LEFT_MID, 100, 0);
-            }
-            
-            // 状态指示
-            lv_obj_t *status_label = lv_label_create(waiting_item);
-            lv_label_set_text(status_label, "等待中");
-            set_font_style(status_label, FONT_TYPE_DEVICE, FONT_SIZE_SMALL);
-            lv_obj_set_style_text_color(status_label, lv_color_hex(0x666666), 0);
-            lv_obj_align(status_label, LV_ALIGN_RIGHT_MID, -10, 0);
-            
-            display_count++;
-        }
+        label_set_text_if_changed(waiting_count_label, count_text);
     }
     
-    // 如果没有等待订单，显示提示
-    if (waiting_count == 0) {
-        lv_obj_t *hint_label = lv_label_create(waiting_orders_container);
-        lv_label_set_text(hint_label, "暂无等待订单");
-        set_font_style(hint_label, FONT_TYPE_DEVICE, FONT_SIZE_MEDIUM);
-        lv_obj_set_style_text_color(hint_label, lv_color_hex(0x999999), 0);
-        lv_obj_center(hint_label);
+    if (UI_GRID_MODE) {
+        bind_waiting_tickets();
+    }
+    
+    // 滚动范围随订单数变化，列表内只保留窗口内的行
+    int listed = waiting_count > WAITING_RANK_BASE ? waiting_count - WAITING_RANK_BASE : 0;
+    int32_t height = listed * WAITING_ROW_PITCH;
+    if (lv_obj_get_style_height(waiting_spacer, LV_PART_MAIN) != height) {
+        lv_obj_set_height(waiting_spacer, height);
+        lv_obj_update_layout(waiting_list);
+        // 订单减少后滚动位置不超过列表末尾
+        int32_t max_y = height - lv_obj_get_content_height(waiting_list);
+        if (max_y < 0) {
+            max_y = 0;
+        }
+        if (lv_obj_get_scroll_y(waiting_list) > max_y) {
+            lv_obj_scroll_to_y(waiting_list, max_y, LV_ANIM_OFF);
+        }
     }
+    bind_waiting_window(waiting_window_first(), true);
+    
+    obj_set_hidden(waiting_hint_label, waiting_count > 0);
+    ui_perf_end(UI_PERF_WAITING_LIST);
+}
+
+static void update_station_label(void)
+{
+    char text[24];
+    snprintf(text, sizeof(text), "Station %u", current_station);
+    lv_label_set_text(station_label, text);
+}
+
+// 切换显示的工位：各工位的焦点与队列保持不变，只重新显示
+static void station_label_cb(lv_event_t *e)
+{
+    bsp_display_lock(portMAX_DELAY);
+    current_station = (current_station + 1) % ORDER_STATION_MAX;
+    update_station_label();
+    lv_obj_scroll_to_y(waiting_list, 0, LV_ANIM_OFF);
+    render_orders();
+    bsp_display_unlock();
+    ESP_LOGI(TAG, "切换到工位 %u", current_station);
 }
 
 // 初始化UI（单订单焦点模式）
@@ -258,49 +857,61 @@ void order_ui_init(lv_obj_t *parent)
 {
     bsp_display_lock(portMAX_DELAY);
     
+    ui_theme_init();
+    
     // 创建主容器 - 允许滚动，但状态栏固定在底部
     main_container = lv_obj_create(parent);
     lv_obj_set_size(main_container, LV_PCT(100), LV_PCT(100));
     lv_obj_set_flex_flow(main_container, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_style_pad_all(main_container, 0, 0);
-    lv_obj_set_style_border_width(main_container, 0, 0);
+    ui_theme_apply(main_container, UI_STYLE_SCREEN);
     lv_obj_set_scrollbar_mode(main_container, LV_SCROLLBAR_MODE_AUTO);
     lv_obj_set_flex_align(main_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
+    ui_perf_init(lv_obj_get_display(parent), main_container);
     
     // 等待订单区域（20%高度）
     waiting_orders_container = lv_obj_create(main_container);
     lv_obj_set_size(waiting_orders_container, LV_PCT(100), LV_PCT(20));
     lv_obj_set_flex_flow(waiting_orders_container, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_style_pad_all(waiting_orders_container, 10, 0);
-    lv_obj_set_style_border_width(waiting_orders_container, 0, 0);
-    lv_obj_set_style_bg_color(waiting_orders_container, lv_color_white(), 0);
+    ui_theme_apply(waiting_orders_container, UI_STYLE_WAITING_AREA);
     
     // 等待订单标题
     lv_obj_t *waiting_title = lv_label_create(waiting_orders_container);
     lv_label_set_text(waiting_title, "等待订单");
-    set_font_style(waiting_title, FONT_TYPE_DEVICE, FONT_SIZE_MEDIUM);
-    lv_obj_set_style_text_color(waiting_title, lv_color_hex(0x333333), 0);
+    ui_theme_apply(waiting_title, UI_STYLE_SECTION_TITLE);
+    create_waiting_list();
     
     // 当前订单区域（自动填充剩余高度）
     current_order_container = lv_obj_create(main_container);
     lv_obj_set_size(current_order_container, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_border_width(current_order_container, 0, 0);
-    lv_obj_set_style_bg_color(current_order_container, lv_color_hex(0xF0F2F5), 0);
+    ui_theme_apply(current_order_container, UI_STYLE_ORDER_AREA);
     // 设置flex_grow为1，自动填充剩余空间
     lv_obj_set_flex_grow(current_order_container, 1);
     
     // 初始显示提示
-    lv_obj_t *hint_label = lv_label_create(current_order_container);
-    lv_label_set_text(hint_label, "等待新订单...");
-    set_font_style(hint_label, FONT_TYPE_DEVICE, FONT_SIZE_LARGE);
-    lv_obj_set_style_text_color(hint_label, lv_color_hex(0x999999), 0);
-    lv_obj_center(hint_label);
+    order_hint_label = lv_label_create(current_order_container);
+    lv_label_set_text(order_hint_label, "等待新订单...");
+    ui_theme_apply(order_hint_label, UI_STYLE_ORDER_HINT);
+    lv_obj_center(order_hint_label);
+    // 实测订单卡片（含预建的菜品卡片）的堆占用与对象数
+    size_t heap_before = UI_COST_LOG ? heap_caps_get_free_size(MALLOC_CAP_DEFAULT) : 0;
+    if (UI_GRID_MODE) {
+        create_ticket_grid();
+    } else {
+        create_order_card();
+    }
+    if (UI_COST_LOG) {
+        size_t heap_after = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        size_t heap_used = heap_before > heap_after ? heap_before - heap_after : 0;
+        ESP_LOGI(TAG, "%s: %u 个对象, 堆 %u 字节",
+                 UI_GRID_MODE ? "小票网格" : "订单卡片",
+                 (unsigned)ui_perf_count_objects(UI_GRID_MODE ? ticket_grid : order_card), (unsigned)heap_used);
+        ui_theme_log_cost(current_order_container);
+    }
     
     // 状态栏（固定高度）- 绝对固定在底部
     status_bar = lv_obj_create(main_container);
     lv_obj_set_size(status_bar, LV_PCT(100), 40);
-    lv_obj_set_style_bg_color(status_bar, lv_color_hex(0xCCCCCC), 0);
-    lv_obj_set_style_border_width(status_bar, 0, 0);
+    ui_theme_apply(status_bar, UI_STYLE_STATUS_BAR);
     lv_obj_set_flex_flow(status_bar, LV_FLEX_FLOW_ROW);
     lv_obj_set_flex_align(status_bar, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     // 设置状态栏不可滚动且固定在底部
@@ -314,26 +925,30 @@ void order_ui_init(lv_obj_t *parent)
     lv_obj_t *left_container = lv_obj_create(status_bar);
     lv_obj_set_size(left_container, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
     lv_obj_set_flex_flow(left_container, LV_FLEX_FLOW_ROW);
-    lv_obj_set_style_bg_opa(left_container, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(left_container, 0, 0);
+    ui_theme_apply(left_container, UI_STYLE_PLAIN);
     
     // 版本信息
     lv_obj_t *version_label = lv_label_create(left_container);
     lv_label_set_text(version_label, "MuLanKDS Focus");
-    lv_obj_set_style_text_font(version_label, &lv_font_montserrat_14, 0);
+    
+    // 当前工位，点击切换到下一个工位
+    station_label = lv_label_create(left_container);
+    ui_theme_apply(station_label, UI_STYLE_STATUS_ITEM);
+    lv_obj_add_flag(station_label, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(station_label, station_label_cb, LV_EVENT_CLICKED, NULL);
+    update_station_label();
     
     // 等待订单数量
     waiting_count_label = lv_label_create(left_container);
     lv_label_set_text(waiting_count_label, "等待订单: 0");
-    lv_obj_set_style_text_font(waiting_count_label, &font_puhui_16_4, 0);
-    lv_obj_set_style_margin_left(waiting_count_label, 20, 0);
+    ui_theme_apply(waiting_count_label, UI_STYLE_STATUS_ITEM);
+    ui_theme_apply(waiting_count_label, UI_STYLE_STATUS_TEXT_CN);
     
     // 蓝牙状态
     bluetooth_label = lv_label_create(left_container);
     lv_label_set_text(bluetooth_label, LV_SYMBOL_BLUETOOTH "Ready");
-    lv_obj_set_style_text_font(bluetooth_label, &lv_font_montserrat_14, 0);
     lv_obj_set_style_text_color(bluetooth_label, lv_color_hex(0xfa5050), 0);
-    lv_obj_set_style_margin_left(bluetooth_label, 20, 0);
+    ui_theme_apply(bluetooth_label, UI_STYLE_STATUS_ITEM);
     
     // 右侧时间
     lv_obj_t *right_container = lv_obj_create(status_bar);
@@ -341,62 +956,68 @@ void order_ui_init(lv_obj_t *parent)
     
     time_label = lv_label_create(right_container);
     lv_label_set_text(time_label, "00:00");
-    lv_obj_set_style_text_font(time_label, &lv_font_montserrat_14, 0);
-    lv_obj_set_style_margin_right(time_label, 100, 0);
+    ui_theme_apply(time_label, UI_STYLE_STATUS_TIME);
+    
+    // 日志回放恢复的订单：各工位排在最前的订单成为焦点
+    if (order_store_count() > 0) {
+        render_orders();
+    }
     
     bsp_display_unlock();
     
     // 初始化时间更新定时器
     init_time_update();
+    
+    // UI就绪后开始处理解析任务投递的事件
+    start_ui_event_task();
 }
 
-// 添加新订单
-void add_new_order(const char *order_id, int order_num, const char *dishes)
+// 新订单按菜品的工位进入各工位队列，工位没有焦点订单时立即成为焦点（调用方持有显示锁）
+static void enqueue_order(order_info_t *new_order)
 {
-    if (!order_id || !dishes) return;
-    
-    bsp_display_lock(portMAX_DELAY);
+    order_store_route(new_order);
+    order_journal_upsert(new_order);
     
-    // 创建新订单
-    order_info_t *new_order = malloc(sizeof(order_info_t));
-    if (!new_order) {
-        bsp_display_unlock();
-        return;
+    if (sync_focus() && current_processing_order == new_order) {
+        ui_popup("新订单开始处理", 2000);
     }
     
-    new_order->order_id = strdup(order_id);
-    new_order->order_num = order_num;
-    new_order->dishes = strdup(dishes);
-    new_order->status = ORDER_STATUS_PENDING;
-    new_order->ui_widget = NULL;
-    
-    if (!new_order->order_id || !new_order->dishes) {
-        free(new_order->order_id);
-        free(new_order->dishes);
-        free(new_order);
-        bsp_display_unlock();
-        return;
+    // 订单不在当前工位时等待列表不变
+    if (!render_deferred && (new_order->stations & (1u << current_station))) {
+        update_waiting_orders_display();
     }
     
-    // 添加到队列
-    STAILQ_INSERT_TAIL(&order_list, new_order, entries);
+    ESP_LOGI(TAG, "新订单添加: %s, 工位 0x%02x", new_order->order_id, new_order->stations);
+}
+
+// 添加新订单
+void add_new_order(const char *order_id, int order_num, const char *dishes)
+{
+    if (!order_id || !dishes) return;
+    
+    bsp_display_lock(portMAX_DELAY);
     
-    // 如果没有当前处理的订单，立即显示这个订单
-    if (!current_processing_order) {
-        new_order->status = ORDER_STATUS_PROCESSING;
-        current_processing_order = new_order;
-        create_current_order_display(new_order);
-        show_popup_message("新订单开始处理", 2000);
+    order_info_t *new_order = order_new(order_id, order_num);
+    if (new_order) {
+        order_load_string(new_order, dishes);
+        enqueue_order(new_order);
     }
     
-    // 更新等待订单显示
-    update_waiting_orders_display();
-    
     bsp_display_unlock();
-    ESP_LOGI(TAG, "新订单添加: %s", order_id);
 }
 
-// 完成当前订单并显示下一个
+// 由解析好的记录添加新订单（UI任务，持有显示锁）
+static void add_order_record(const order_record_t *rec)
+{
+    order_info_t *new_order = order_new(rec->order_id, rec->order_num);
+    if (new_order) {
+        order_store_set_priority(new_order, rec->priority, rec->deadline);
+        order_load_record(new_order, rec);
+        enqueue_order(new_order);
+    }
+}
+
+// 整单完成（POS确认或删除），订单离开所有工位，各工位显示下一个
 void complete_current_order(const char *order_id)
 {
     if (!order_id || strlen(order_id) == 0) {
@@ -408,80 +1029,49 @@ void complete_current_order(const char *order_id)
     
     ESP_LOGI(TAG, "开始完成订单: %s", order_id);
     
-    // 首先设置订单状态为完成
-    order_info_t *order;
-    bool found_order = false;
-    STAILQ_FOREACH(order, &order_list, entries) {
-        if (order && order->order_id && strcmp(order->order_id, order_id) == 0) {
-            ESP_LOGI(TAG, "找到订单 %s，设置状态为COMPLETED", order_id);
-            order->status = ORDER_STATUS_COMPLETED;
-            found_order = true;
-            break;
-        }
-    }
-    
-    if (!found_order) {
+    order_info_t *order = order_store_find(order_id);
+    if (!order) {
         ESP_LOGW(TAG, "未找到订单: %s", order_id);
         bsp_display_unlock();
         return;
     }
     
-    // 查找并移除已完成的订单
-    order_info_t *tmp;
-    bool removed = false;
-    STAILQ_FOREACH_SAFE(order, &order_list, entries, tmp) {
-        if (order && order->order_id && strcmp(order->order_id, order_id) == 0 && order->status == ORDER_STATUS_COMPLETED) {
-            ESP_LOGI(TAG, "移除已完成订单: %s", order_id);
-            // 从队列中移除已完成订单
-            STAILQ_REMOVE(&order_list, order, order_info, entries);
-            if (order->order_id) free(order->order_id);
-            if (order->dishes) free(order->dishes);
-            free(order);
-            removed = true;
-            break;
+    ESP_LOGI(TAG, "移除已完成订单: %s", order_id);
+    order_free(order);
+    
+    // 焦点订单完成后对应工位切换到下一个等待订单，没有时显示等待提示
+    if (sync_focus()) {
+        if (current_processing_order) {
+            ui_popup("开始处理下一个订单", 2000);
+            ESP_LOGI(TAG, "切换到下一个订单: %s", current_processing_order->order_id);
+        } else {
+            ESP_LOGI(TAG, "没有更多订单，显示等待提示");
         }
     }
     
-    if (!removed) {
-        ESP_LOGW(TAG, "未能移除订单: %s", order_id);
+    // 更新等待订单显示
+    if (!render_deferred) {
+        update_waiting_orders_display();
     }
     
-    // 如果当前处理的订单是完成的订单，清空当前订单
-    if (current_processing_order && current_processing_order->order_id && strcmp(current_processing_order->order_id, order_id) == 0) {
-        current_processing_order = NULL;
-    }
+    bsp_display_unlock();
+}
+
+// 当前订单区域显示等待提示
+static void show_waiting_hint(void)
+{
+    if (!order_hint_label) return;
     
-    // 查找下一个等待订单
-    order_info_t *next_order = NULL;
-    bool found_next = false;
-    STAILQ_FOREACH(next_order, &order_list, entries) {
-        if (next_order->status == ORDER_STATUS_PENDING) {
-            next_order->status = ORDER_STATUS_PROCESSING;
-            current_processing_order = next_order;
-            create_current_order_display(next_order);
-            show_popup_message("开始处理下一个订单", 2000);
-            ESP_LOGI(TAG, "切换到下一个订单: %s", next_order->order_id);
-            found_next = true;
-            break;
+    if (UI_GRID_MODE) {
+        for (int i = 0; i < TICKET_GRID_SIZE; i++) {
+            bind_ticket(&ticket_cells[i], NULL);
         }
+        obj_set_hidden(ticket_grid, true);
+    } else {
+        obj_set_hidden(order_card, true);
     }
-    
-    // 如果没有更多订单，显示等待提示
-    if (!found_next) {
-        ESP_LOGI(TAG, "没有更多订单，显示等待提示");
-        current_processing_order = NULL;
-        lv_obj_clean(current_order_container);
-        lv_obj_t *hint_label = lv_label_create(current_order_container);
-        lv_label_set_text(hint_label, "等待新订单...");
-        set_font_style(hint_label, FONT_TYPE_DEVICE, FONT_SIZE_LARGE);
-        lv_obj_set_style_text_color(hint_label, lv_color_hex(0x999999), 0);
-        lv_obj_center(hint_label);
-    }
-    
-    // 更新等待订单显示
-    update_waiting_orders_display();
-    
-    bsp_display_unlock();
+    obj_set_hidden(order_hint_label, false);
+    displayed_order = NULL;
 }
 
 // 获取当前订单ID
@@ -490,18 +1080,11 @@ const char* get_current_order_id(void)
     return current_processing_order ? current_processing_order->order_id : NULL;
 }
 
-// 获取等待订单数量
+// 获取当前工位的等待订单数量（由订单存储增量维护）
 int get_waiting_orders_count(void)
 {
-    int count = 0;
-    order_info_t *order;
-    
     bsp_display_lock(portMAX_DELAY);
-    STAILQ_FOREACH(order, &order_list, entries) {
-        if (order->status == ORDER_STATUS_PENDING) {
-            count++;
-        }
-    }
+    int count = order_store_pending_count(current_station);
     bsp_display_unlock();
     
     return count;
@@ -525,50 +1108,185 @@ void remove_order_by_id(const char *order_id)
     // 在单订单焦点模式下，移除订单需要特殊处理
     bsp_display_lock(portMAX_DELAY);
     
-    order_info_t *order, *tmp;
-    STAILQ_FOREACH_SAFE(order, &order_list, entries, tmp) {
-        if (strcmp(order->order_id, order_id) == 0) {
-            if (order == current_processing_order) {
-                // 如果是当前订单，完成它
-                complete_current_order(order_id);
-            } else {
-                // 如果是等待订单，直接移除
-                STAILQ_REMOVE(&order_list, order, order_info, entries);
-                if (order->ui_widget && lv_obj_is_valid(order->ui_widget)) {
-                    lv_obj_del(order->ui_widget);
-                }
-                free(order->order_id);
-                free(order->dishes);
-                free(order);
-                update_waiting_orders_display();
-            }
-            break;
+    order_info_t *order = order_store_find(order_id);
+    if (!order) {
+        ESP_LOGW(TAG, "未找到订单: %s", order_id);
+    } else if (order->focus) {
+        // 如果是某个工位的焦点订单，完成它
+        complete_current_order(order_id);
+    } else {
+        // 如果是等待订单，直接移除
+        order_free(order);
+        if (!render_deferred) {
+            update_waiting_orders_display();
         }
     }
     
     bsp_display_unlock();
 }
 
+static bool ranks_contain(int first, int max, const order_info_t *order)
+{
+    order_info_t *rows[WAITING_ROW_POOL];
+    int n = order_store_pending_range(current_station, first, rows, max);
+    for (int i = 0; i < n; i++) {
+        if (rows[i] == order) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 订单是否在等待列表当前绑定的行中（网格模式下含小票上的前几名）
+static bool order_in_waiting_rows(const order_info_t *order)
+{
+    if (UI_GRID_MODE && ranks_contain(0, WAITING_RANK_BASE, order)) {
+        return true;
+    }
+    return ranks_contain(WAITING_RANK_BASE + waiting_first, WAITING_ROW_POOL, order);
+}
+
+// 按消息调整优先级；返回等待列表是否需要刷新（订单移入、移出或在显示的行内移动）
+static bool apply_priority(order_info_t *order, const order_record_t *rec)
+{
+    if (!rec->has_priority || (order->priority == rec->priority && order->deadline == rec->deadline)) {
+        return false;
+    }
+    bool shown = order_in_waiting_rows(order);
+    order_store_set_priority(order, rec->priority, rec->deadline);
+    ESP_LOGI(TAG, "订单 %s 优先级: %u, 期限: %lu", order->order_id, rec->priority, (unsigned long)rec->deadline);
+    return shown || order_in_waiting_rows(order);
+}
+
+// 整单替换后重新分配工位并刷新：当前订单重新绑定卡片；等待订单只在显示的行受影响时刷新等待列表
+static void refresh_order(order_info_t *order, bool rows_dirty)
+{
+    uint8_t open = order_store_open_stations(order);
+    if (reroute_order(order)) {
+        order = NULL;
+        rows_dirty = true;
+    } else if (order_store_open_stations(order) != open) {
+        rows_dirty = true;
+    }
+    
+    bool refocused = sync_focus();
+    if (render_deferred) {
+        return;
+    }
+    if (order && order == current_processing_order) {
+        if (!refocused) {
+            show_current_order(order);
+        }
+    } else if (refocused || rows_dirty || (order && order_in_waiting_rows(order))) {
+        update_waiting_orders_display();
+    }
+}
+
 void update_order_by_id(const char *order_id, int order_num, const char *dishes)
 {
     bsp_display_lock(portMAX_DELAY);
     
-    order_info_t *order;
-    STAILQ_FOREACH(order, &order_list, entries) {
-        if (strcmp(order->order_id, order_id) == 0) {
-            order->order_num = order_num;
-            free(order->dishes);
-            order->dishes = strdup(dishes);
-            
-            // 如果是当前订单，更新显示
-            if (order == current_processing_order) {
-                create_current_order_display(order);
+    order_info_t *order = order_store_find(order_id);
+    if (order) {
+        order->order_num = order_num;
+        reopen_for_string(order, dishes);
+        order_load_string(order, dishes);
+        refresh_order(order, false);
+    }
+    
+    bsp_display_unlock();
+}
+
+static void update_order_record(const order_record_t *rec)
+{
+    order_info_t *order = order_store_find(rec->order_id);
+    if (order) {
+        order->order_num = rec->order_num;
+        bool rows_dirty = apply_priority(order, rec);
+        reopen_grown_stations(order, rec);
+        order_load_record(order, rec);
+        refresh_order(order, rows_dirty);
+    }
+}
+
+// 增量编辑：就地修改菜品数组，当前订单只重新绑定受影响的菜品卡片
+static void edit_order_record(const order_record_t *rec)
+{
+    order_info_t *order = order_store_find(rec->order_id);
+    if (!order) {
+        ESP_LOGW(TAG, "增量编辑的订单不存在: %s", rec->order_id);
+        return;
+    }
+    
+    // 网格模式的小票在编辑结束后整张重新绑定
+    bool patch = !UI_GRID_MODE && order == displayed_order && !render_deferred;
+    bool rows_dirty = apply_priority(order, rec);
+    uint8_t open = order_store_open_stations(order);
+    
+    for (int i = 0; i < rec->item_count; i++) {
+        const order_item_t *item = &rec->items[i];
+        const char *mods = order_record_item_mods(rec, i);
+        int idx = dish_find(order, order_record_item_name(rec, i), item->name_len);
+        
+        if (idx < 0) {
+            if (item->qty == 0) {
+                continue;
             }
-            break;
+            if (!order_store_append_dish(order, order_record_item_name(rec, i), item->name_len, item->qty,
+                             mods, item->mods_len, item->station)) {
+                ESP_LOGE(TAG, "菜品内存分配失败");
+                break;
+            }
+            // 已出餐的工位加菜时重新打开该工位的子单
+            order->done &= ~(1u << order->items[order->item_count - 1].station);
+            if (patch) {
+                bind_dish_slot(order, order->item_count - 1);
+            }
+            continue;
+        }
+        
+        order_dish_t *dish = &order->items[idx];
+        if (item->qty == 0) {
+            dish_remove(order, idx);
+            if (patch) {
+                bind_dishes(order, idx);
+            }
+            continue;
+        }
+        
+        // 未携带备注时保留原备注
+        bool mods_changed = item->has_mods &&
+            (item->mods_len != dish->mods_len || memcmp(mods, dish_mods(order, dish), item->mods_len) != 0);
+        if (item->qty > dish->qty) {
+            order->done &= ~(1u << dish->station);
+        }
+        dish->qty = item->qty;
+        if (mods_changed && !order_store_set_dish_mods(order, dish, mods, item->mods_len)) {
+            ESP_LOGE(TAG, "菜品内存分配失败");
+        }
+        
+        if (patch) {
+            bind_dish_slot(order, idx);
         }
     }
     
-    bsp_display_unlock();
+    ESP_LOGI(TAG, "增量编辑订单 %s: %d 项变更，现有 %d 个菜品", rec->order_id, rec->item_count, order->item_count);
+    
+    // 菜品增删可能使订单进入或离开工位
+    if (reroute_order(order)) {
+        order = NULL;
+        rows_dirty = true;
+    } else if (order_store_open_stations(order) != open) {
+        rows_dirty = true;
+    }
+    bool refocused = sync_focus();
+    if (UI_GRID_MODE && !render_deferred && !refocused && order && order == current_processing_order) {
+        show_current_order(order);
+    }
+    if (!render_deferred && order != current_processing_order &&
+        (refocused || rows_dirty || (order && rec->item_count > 0 && order_in_waiting_rows(order)))) {
+        update_waiting_orders_display();
+    }
 }
 
 // 其他现有函数保持不变
@@ -663,14 +1381,10 @@ void show_popup_message(const char *message, uint32_t duration_ms) {
 
     lv_obj_set_size(popup, 280, 80);
     lv_obj_center(popup);
-    lv_obj_set_style_bg_color(popup, lv_color_black(), 0);
-    lv_obj_set_style_bg_opa(popup, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(popup, 0, 0);
+    ui_theme_apply(popup, UI_STYLE_POPUP);
     
     lv_obj_t *label = lv_label_create(popup);
     lv_label_set_text(label, message);
-    lv_obj_set_style_text_color(label, lv_color_white(), 0);
-    lv_obj_set_style_text_font(label, &font_puhui_16_4, 0);
     lv_obj_center(label);
 
     lv_timer_t *timer = lv_timer_create(popup_timer_cb, duration_ms, popup);
@@ -700,55 +1414,23 @@ static void time_update_timer_cb(lv_timer_t *timer) {
 
 // 显示等待新订单状态
 static void show_waiting_for_orders(void) {
-    if (!current_order_container) return;
-    
-    // 清空当前订单容器
-    lv_obj_clean(current_order_container);
-    
-    // 创建等待新订单的显示
-    lv_obj_t *waiting_container = lv_obj_create(current_order_container);
-    lv_obj_set_size(waiting_container, LV_PCT(95), 500);
-    lv_obj_set_style_bg_color(waiting_container, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_border_width(waiting_container, 0, 0);
-    lv_obj_center(waiting_container);
-    
-    lv_obj_t *waiting_label = lv_label_create(waiting_container);
-    lv_label_set_text(waiting_label, "等待新订单");
-    lv_obj_set_style_text_font(waiting_label, &lv_font_mulan_24, 0);
-    lv_obj_set_style_text_color(waiting_label, lv_color_hex(0x999999), 0);
-    lv_obj_center(waiting_label);
+    show_waiting_hint();
     
-    // 清空等待订单容器
-    if (waiting_orders_container) {
-        lv_obj_clean(waiting_orders_container);
-    }
-    
-    // 更新等待订单数量显示
-    if (waiting_count_label) {
-        lv_label_set_text(waiting_count_label, "等待: 0");
-    }
+    // 隐藏全部等待订单行，更新等待订单数量
+    update_waiting_orders_display();
 }
 
 // 清空所有订单并重置系统状态
 void clear_all_orders(void) {
     bsp_display_lock(portMAX_DELAY);
     
-    // 遍历并删除所有订单
-    order_info_t *order, *temp;
-    STAILQ_FOREACH_SAFE(order, &order_list, entries, temp) {
-        // 删除UI控件
-        if (order->ui_widget && lv_obj_is_valid(order->ui_widget)) {
-            lv_obj_del(order->ui_widget);
-        }
-        // 释放内存
-        if (order->order_id) free(order->order_id);
-        if (order->dishes) free(order->dishes);
-        free(order);
-    }
-    
-    // 重置队列
-    STAILQ_INIT(&order_list);
+    // 订单卡片与等待行为常驻控件，只需解除绑定
     current_processing_order = NULL;
+    focus_stale = false;
+    
+    // 删除所有订单，订单记录归还到池中
+    order_store_clear();
+    order_journal_clear();
     
     // 显示等待新订单状态
     show_waiting_for_orders();
@@ -766,3 +1448,227 @@ void init_time_update(void) {
     }
 }
 
+// 在显示锁内应用一个订单事件
+static void apply_order_event(order_event_t *evt)
+{
+    order_record_t *rec = evt->record;
+    
+    switch (evt->type) {
+    case ORDER_EVENT_ADD:
+        add_order_record(rec);
+        ui_popup("新订单已接收", 2000);
+        break;
+    case ORDER_EVENT_UPDATE:
+        update_order_record(rec);
+        ui_popup("订单已更新", 2000);
+        break;
+    case ORDER_EVENT_EDIT:
+        edit_order_record(rec);
+        ui_popup("订单已更新", 2000);
+        break;
+    case ORDER_EVENT_COMPLETE:
+        complete_current_order(rec->order_id);
+        ui_popup("订单已完成", 2000);
+        break;
+    case ORDER_EVENT_REMOVE:
+        remove_order_by_id(rec->order_id);
+        ui_popup("订单已删除", 2000);
+        break;
+    case ORDER_EVENT_CLEAR:
+        clear_all_orders();
+        ui_popup("所有订单已清空", 2000);
+        break;
+    case ORDER_EVENT_MESSAGE:
+        if (order_record_content(rec)) {
+            ui_popup(order_record_content(rec), 3000);
+        }
+        break;
+    case ORDER_EVENT_TIME:
+        update_time_display(evt->timestamp);
+        break;
+    case ORDER_EVENT_BATCH_BEGIN:
+    case ORDER_EVENT_BATCH_END:
+        // 批量超时结束后迟到的边界事件，忽略
+        break;
+    default:
+        ESP_LOGW(TAG, "未知的订单事件: %d", evt->type);
+        break;
+    }
+}
+
+// 批量结束或切换工位后按最终订单队列刷新一次界面
+static void render_orders(void)
+{
+    advance_stations();
+    current_processing_order = order_store_focus(current_station);
+    focus_stale = false;
+    if (current_processing_order) {
+        show_current_order(current_processing_order);
+    } else {
+        show_waiting_hint();
+    }
+    update_waiting_orders_display();
+}
+
+// 是否为计入处理耗时统计的订单操作（时间同步、系统消息等不计）
+static bool is_order_op(order_event_type_t type)
+{
+    return type == ORDER_EVENT_ADD || type == ORDER_EVENT_UPDATE || type == ORDER_EVENT_EDIT ||
+           type == ORDER_EVENT_COMPLETE || type == ORDER_EVENT_REMOVE;
+}
+
+// 应用整个批量：队列中已有的事件在一次显示锁内连续应用，期间界面不重绘。
+// 等待下一条事件前先按当前队列刷新界面并释放显示锁，发送方变慢时渲染与触摸不被阻塞，
+// 小票与卡片也不会在等待期间指向已移除的订单。
+static void apply_batch(void)
+{
+    order_event_t evt;
+    int applied = 0;
+    int64_t start_us = esp_timer_get_time();
+    int64_t work_us = 0;    // 不含等待下一条事件的时间
+    int gaps = 0;
+    
+    bsp_display_lock(portMAX_DELAY);
+    
+    for (;;) {
+        if (xQueueReceive(ui_event_queue, &evt, 0) != pdTRUE) {
+            if (render_deferred) {
+                int64_t t0 = esp_timer_get_time();
+                render_deferred = false;
+                render_orders();
+                work_us += esp_timer_get_time() - t0;
+            }
+            bsp_display_unlock();
+            
+            BaseType_t got = xQueueReceive(ui_event_queue, &evt, pdMS_TO_TICKS(UI_BATCH_WAIT_MS));
+            
+            bsp_display_lock(portMAX_DELAY);
+            if (got != pdTRUE) {
+                ESP_LOGW(TAG, "等待批量结束超时，已应用 %d 条", applied);
+                break;
+            }
+            gaps++;
+        }
+        if (evt.type == ORDER_EVENT_BATCH_END) {
+            break;
+        }
+        int64_t t0 = esp_timer_get_time();
+        render_deferred = true;
+        apply_order_event(&evt);
+        work_us += esp_timer_get_time() - t0;
+        order_record_release(evt.record);
+        applied++;
+    }
+    
+    int64_t t0 = esp_timer_get_time();
+    if (render_deferred) {
+        render_deferred = false;
+        render_orders();
+    }
+    
+    char msg[48];
+    snprintf(msg, sizeof(msg), "批量同步 %d 个订单", applied);
+    show_popup_message(msg, 2000);
+    work_us += esp_timer_get_time() - t0;
+    bsp_display_unlock();
+    
+    batch_count++;
+    batch_ops_total += applied;
+    batch_us_total += (uint32_t)work_us;
+    if ((uint32_t)applied > batch_ops_max) {
+        batch_ops_max = applied;
+    }
+    if ((uint32_t)work_us > batch_us_max) {
+        batch_us_max = (uint32_t)work_us;
+    }
+    ESP_LOGI(TAG, "批量应用 %d 条，处理 %lld us（%lld us/条，逐条应用平均 %lu us/条），等待 %d 次，总用时 %lld us",
+             applied, (long long)work_us, applied ? (long long)work_us / applied : 0LL,
+             (unsigned long)(single_ops ? single_us_total / single_ops : 0), gaps,
+             (long long)(esp_timer_get_time() - start_us));
+}
+
+void order_ui_get_apply_stats(order_ui_apply_stats_t *stats)
+{
+    if (!stats) return;
+    
+    stats->single_ops = single_ops;
+    stats->single_us_avg = single_ops ? single_us_total / single_ops : 0;
+    stats->single_us_max = single_us_max;
+    stats->batches = batch_count;
+    stats->batch_ops_max = batch_ops_max;
+    stats->batch_us_per_op = batch_ops_total ? batch_us_total / batch_ops_total : 0;
+    stats->batch_us_max = batch_us_max;
+}
+
+// UI事件任务：从队列取出解析好的事件并更新界面
+static void ui_event_task_fn(void *arg)
+{
+    order_event_t evt;
+    
+    for (;;) {
+        if (xQueueReceive(ui_event_queue, &evt, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        
+        if (evt.type == ORDER_EVENT_BATCH_BEGIN) {
+            apply_batch();
+            continue;
+        }
+        
+        bsp_display_lock(portMAX_DELAY);
+        int64_t t0 = esp_timer_get_time();
+        apply_order_event(&evt);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+        bsp_display_unlock();
+        
+        if (is_order_op(evt.type)) {
+            single_ops++;
+            single_us_total += us;
+            if (us > single_us_max) {
+                single_us_max = us;
+            }
+        }
+        order_record_release(evt.record);
+    }
+}
+
+esp_err_t order_ui_events_init(void)
+{
+    if (ui_event_queue) {
+        return ESP_OK;
+    }
+    
+    esp_err_t ret = order_store_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ui_event_queue = xQueueCreate(UI_EVENT_QUEUE_LEN, sizeof(order_event_t));
+    if (!ui_event_queue) {
+        ESP_LOGE(TAG, "创建UI事件队列失败");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static void start_ui_event_task(void)
+{
+    if (ui_event_task || !ui_event_queue) {
+        return;
+    }
+    
+    if (xTaskCreate(ui_event_task_fn, "order_ui", UI_TASK_STACK_SIZE,
+                    NULL, UI_TASK_PRIORITY, &ui_event_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建UI事件任务失败");
+    }
+}
+
+bool order_ui_post_event(const order_event_t *evt)
+{
+    if (!ui_event_queue || !evt) {
+        return false;
+    }
+    
+    // 队列满时阻塞解析任务，由接收环形缓冲区吸收突发
+    return xQueueSend(ui_event_queue, evt, portMAX_DELAY) == pdTRUE;
+}
@@ -1,14 +1,52 @@
 #ifndef ORDER_UI_H
 #define ORDER_UI_H
 
+#include <stdbool.h>
 #include "lvgl.h"
+#include "esp_err.h"
+#include "order_event.h"
 
 // 订单焦点模式配置
-#define MAX_WAITING_ORDERS_DISPLAY 5  // 最大显示等待订单数量
+#define MAX_WAITING_ORDERS_DISPLAY 5  // 等待订单列表可见行数，更多订单滚动查看
 
-// 初始化订单UI容器（单订单焦点模式）
+// 初始化订单UI容器（单订单焦点模式），并启动UI事件任务
 void order_ui_init(lv_obj_t *parent);
 
+/**
+ * @brief 创建UI事件队列，需在接收阶段启动前调用
+ * 
+ * @return esp_err_t 成功返回ESP_OK
+ */
+esp_err_t order_ui_events_init(void);
+
+/**
+ * @brief 将订单事件交给UI任务处理（由解析任务调用）
+ * 
+ * 事件按值复制进队列，record 的所有权随之转移给UI任务。
+ * 
+ * @param evt 订单事件
+ * @return true 投递成功
+ */
+bool order_ui_post_event(const order_event_t *evt);
+
+// 订单操作在UI任务中的处理耗时（显示锁内的模型更新与界面调和，不含LVGL渲染）
+typedef struct {
+    uint32_t single_ops;        // 逐条应用的订单操作数
+    uint32_t single_us_avg;     // 逐条应用的平均耗时（微秒/条）
+    uint32_t single_us_max;
+    uint32_t batches;           // 应用的批量消息数
+    uint32_t batch_ops_max;     // 单个批量的最大操作数
+    uint32_t batch_us_per_op;   // 批量中平均每条操作的耗时（含界面刷新的分摊，发送方停顿时每次停顿刷新一次）
+    uint32_t batch_us_max;      // 单个批量的最大总耗时
+} order_ui_apply_stats_t;
+
+/**
+ * @brief 获取订单操作的处理耗时统计，用于比较逐条与批量应用
+ * 
+ * @param stats 输出统计
+ */
+void order_ui_get_apply_stats(order_ui_apply_stats_t *stats);
+
 /**
  * @brief 添加新订单到系统（单订单焦点模式）
  * 
@@ -47,14 +85,6 @@ int get_waiting_orders_count(void);
  */
 void show_popup_message(const char *message, uint32_t duration_ms);
 
-/**
- * @brief 发送蓝牙通知
- * 
- * @param json_str JSON格式的字符串
- * @return int 成功返回0，失败返回-1
- */
-int send_notification(const char *json_str);
-
 /**
  * @brief 更新蓝牙连接状态显示
  * 
@@ -0,0 +1,74 @@
+/**
+ * @file spsc_ring.c
+ * @brief 无锁单生产者/单消费者环形缓冲区实现
+ */
+
+#include "spsc_ring.h"
+
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, size_t slot_size, uint32_t slot_count)
+{
+    if (!ring || !storage || slot_size == 0 || slot_count == 0 ||
+        (slot_count & (slot_count - 1)) != 0) {
+        return false;
+    }
+
+    ring->slots = storage;
+    ring->slot_size = slot_size;
+    ring->slot_count = slot_count;
+    ring->mask = slot_count - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->high_water, 0);
+    atomic_init(&ring->dropped, 0);
+    return true;
+}
+
+void *spsc_ring_acquire(spsc_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail >= ring->slot_count) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    return ring->slots + (size_t)(head & ring->mask) * ring->slot_size;
+}
+
+void spsc_ring_push(spsc_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed) + 1;
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+
+    // 只有生产者更新高水位，无需CAS
+    uint32_t depth = head - atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (depth > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, depth, memory_order_relaxed);
+    }
+}
+
+void *spsc_ring_peek(spsc_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+
+    return ring->slots + (size_t)(tail & ring->mask) * ring->slot_size;
+}
+
+void spsc_ring_pop(spsc_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed) + 1;
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+}
+
+uint32_t spsc_ring_depth(const spsc_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
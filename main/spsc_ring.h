@@ -0,0 +1,68 @@
+/**
+ * @file spsc_ring.h
+ * @brief 无锁单生产者/单消费者环形缓冲区
+ *
+ * 固定数量、固定大小的槽位。生产者与消费者各自只写自己的索引，
+ * 通过 acquire/release 内存序同步，不需要任何互斥锁。
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    uint8_t *slots;             // 槽位存储区
+    size_t slot_size;           // 单个槽位字节数
+    uint32_t slot_count;        // 槽位数量（必须为2的幂）
+    uint32_t mask;
+    _Atomic uint32_t head;      // 生产者写入位置
+    _Atomic uint32_t tail;      // 消费者读取位置
+    _Atomic uint32_t high_water; // 历史最大深度
+    _Atomic uint32_t dropped;   // 满时丢弃次数
+} spsc_ring_t;
+
+/**
+ * @brief 初始化环形缓冲区
+ *
+ * @param ring 环形缓冲区
+ * @param storage 槽位存储区，大小至少为 slot_size * slot_count
+ * @param slot_size 单个槽位字节数
+ * @param slot_count 槽位数量，必须为2的幂
+ * @return true 初始化成功
+ */
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, size_t slot_size, uint32_t slot_count);
+
+/**
+ * @brief 生产者获取一个空闲槽位
+ *
+ * @return void* 空闲槽位，缓冲区已满时返回NULL并累计丢弃计数
+ */
+void *spsc_ring_acquire(spsc_ring_t *ring);
+
+/**
+ * @brief 生产者提交最近一次获取的槽位
+ */
+void spsc_ring_push(spsc_ring_t *ring);
+
+/**
+ * @brief 消费者查看最早的已提交槽位
+ *
+ * @return void* 槽位指针，缓冲区为空时返回NULL
+ */
+void *spsc_ring_peek(spsc_ring_t *ring);
+
+/**
+ * @brief 消费者释放最近一次查看的槽位
+ */
+void spsc_ring_pop(spsc_ring_t *ring);
+
+/**
+ * @brief 当前队列深度
+ */
+uint32_t spsc_ring_depth(const spsc_ring_t *ring);
+
+#endif // SPSC_RING_H
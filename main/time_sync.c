@@ -0,0 +1,139 @@
+#include "time_sync.h"
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+static const char *TAG = "TimeSync";
+
+// 外部声明update_time_display函数
+extern void update_time_display(long long timestamp);
+
+// 将 "9/28/2025, 6:00:26 PM" 格式转换为Unix时间戳
+long long parse_timestamp_string(const char* timestamp_str) {
+    if (!timestamp_str) return 0;
+    
+    struct tm tm = {0};
+    char am_pm[3] = {0};
+    int parsed_fields;
+    
+    // 解析格式: "9/28/2025, 6:00:26 PM"
+    parsed_fields = sscanf(timestamp_str, "%d/%d/%d, %d:%d:%d %2s", 
+                          &tm.tm_mon, &tm.tm_mday, &tm.tm_year,
+                          &tm.tm_hour, &tm.tm_min, &tm.tm_sec, am_pm);
+    
+    if (parsed_fields == 7) {
+        // 验证输入数据的有效性
+        if (tm.tm_mon < 1 || tm.tm_mon > 12 || 
+            tm.tm_mday < 1 || tm.tm_mday > 31 ||
+            tm.tm_year < 2020 || tm.tm_year > 2100 ||
+            tm.tm_hour < 0 || tm.tm_hour > 23 ||
+            tm.tm_min < 0 || tm.tm_min > 59 ||
+            tm.tm_sec < 0 || tm.tm_sec > 59) {
+            ESP_LOGE(TAG, "无效的时间戳格式: %s", timestamp_str);
+            return 0;
+        }
+        
+        // 调整年份和月份格式
+        tm.tm_year -= 1900;  // 年份从1900开始
+        tm.tm_mon -= 1;      // 月份从0开始
+        
+        // 处理AM/PM
+        if (strcmp(am_pm, "PM") == 0 && tm.tm_hour < 12) {
+            tm.tm_hour += 12;
+        } else if (strcmp(am_pm, "AM") == 0 && tm.tm_hour == 12) {
+            tm.tm_hour = 0;
+        }
+        
+        // 转换为Unix时间戳
+        time_t ts = mktime(&tm);
+        if (ts == -1) {
+            ESP_LOGE(TAG, "时间戳转换失败: %s", timestamp_str);
+            return 0;
+        }
+        
+        return (long long)ts * 1000;  // 转换为毫秒
+    }
+    
+    ESP_LOGE(TAG, "时间戳解析失败，期望7个字段，实际解析%d个: %s", parsed_fields, timestamp_str);
+    return 0;
+}
+
+// 保存时间到NVS
+void save_time_to_nvs(long long timestamp) {
+    if (timestamp <= 0) {
+        ESP_LOGE(TAG, "无效的时间戳: %lld", timestamp);
+        return;
+    }
+    
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open("storage", NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "打开NVS失败: %s", esp_err_to_name(err));
+        return;
+    }
+    
+    // 检查时间戳是否合理（不能是未来的时间）
+    time_t current_time = time(NULL);
+    time_t timestamp_sec = (time_t)(timestamp / 1000);
+    
+    if (timestamp_sec > current_time + 3600) { // 如果时间戳比当前时间晚1小时以上
+        ESP_LOGW(TAG, "时间戳可能无效，比当前时间晚: %lld", timestamp);
+    }
+    
+    err = nvs_set_i64(nvs_handle, "system_time", timestamp);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存时间到NVS失败: %s", esp_err_to_name(err));
+        nvs_close(nvs_handle);
+        return;
+    }
+    
+    err = nvs_commit(nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS提交失败: %s", esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "时间已保存到NVS: %lld", timestamp);
+    }
+    
+    nvs_close(nvs_handle);
+}
+
+// 从NVS恢复时间
+void restore_time_from_nvs(void) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open("storage", NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGI(TAG, "打开NVS失败或没有保存的时间");
+        return;
+    }
+    
+    int64_t saved_time = 0;
+    err = nvs_get_i64(nvs_handle, "system_time", &saved_time);
+    nvs_close(nvs_handle);
+    
+    if (err == ESP_OK && saved_time > 0) {
+        // 验证保存的时间是否合理
+        time_t current_time = time(NULL);
+        time_t saved_time_sec = (time_t)(saved_time / 1000);
+        
+        if (saved_time_sec > current_time + 86400) { // 如果保存的时间比当前时间晚1天以上
+            ESP_LOGW(TAG, "保存的时间可能无效: %lld", saved_time);
+            return;
+        }
+        
+        ESP_LOGI(TAG, "从NVS恢复时间: %lld", saved_time);
+        update_time_display(saved_time);
+        
+        // 设置系统时间
+        time_t ts = (time_t)(saved_time / 1000);
+        struct timeval tv = { .tv_sec = ts, .tv_usec = 0 };
+        if (settimeofday(&tv, NULL) != 0) {
+            ESP_LOGE(TAG, "设置系统时间失败");
+        }
+    } else {
+        ESP_LOGI(TAG, "没有找到保存的时间数据");
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+/**
+ * @brief 将 "9/28/2025, 6:00:26 PM" 格式转换为Unix时间戳
+ *
+ * @param timestamp_str 时间字符串
+ * @return long long 毫秒时间戳，解析失败返回0
+ */
+long long parse_timestamp_string(const char* timestamp_str);
+
+/**
+ * @brief 保存时间到NVS
+ *
+ * @param timestamp 毫秒时间戳
+ */
+void save_time_to_nvs(long long timestamp);
+
+/**
+ * @brief 从NVS恢复时间并设置系统时间
+ */
+void restore_time_from_nvs(void);
+
+#endif // TIME_SYNC_H
@@ -0,0 +1,181 @@
+#include "ui_perf.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+
+static const char *TAG = "UIPerf";
+
+// 周期为0时不挂事件、不计时也不遍历对象树，包围的代码段不增加任何开销
+#define UI_PERF_ENABLED (CONFIG_KDS_UI_PERF_LOG_PERIOD > 0)
+
+typedef struct {
+    const char *name;
+    bool active;
+    uint32_t calls;
+    uint32_t logged_calls;      // 上次写日志时的调用次数，无新调用时不重复输出
+    uint64_t us_total;
+    uint32_t us_max;
+    uint64_t inv_areas_total;
+    uint64_t inv_px_total;
+    uint32_t inv_px_max;
+    int32_t objs_delta_total;   // 对象数净变化的累计，稳定状态下应保持为0
+    uint32_t objs_grew;         // 对象数增加的次数
+    uint32_t frames;
+    uint64_t frame_us_total;
+    uint32_t frame_us_max;
+    // 进行中的一次调用
+    int64_t start_us;
+    uint32_t start_inv_areas;
+    uint64_t start_inv_px;
+    uint32_t start_objs;
+} perf_section_t;
+
+static perf_section_t s_sections[UI_PERF_SECTION_COUNT] = {
+    [UI_PERF_WAITING_LIST] = { .name = "等待列表" },
+    [UI_PERF_TICKET_BUMP] = { .name = "小票完成" },
+};
+
+static lv_obj_t *s_root = NULL;
+
+// 显示上的失效区域累计，代码段按开始与结束时的差值计数
+static uint32_t s_inv_areas = 0;
+static uint64_t s_inv_px = 0;
+
+// 已结束、还在等待下一帧渲染的代码段（位图）
+static uint32_t s_frame_waiters = 0;
+static int64_t s_render_start_us = 0;
+
+_Static_assert(UI_PERF_SECTION_COUNT <= 32, "等待渲染的代码段以 uint32_t 位图保存");
+
+static lv_obj_tree_walk_res_t count_cb(lv_obj_t *obj, void *user_data)
+{
+    (*(uint32_t *)user_data)++;
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+uint32_t ui_perf_count_objects(lv_obj_t *root)
+{
+    uint32_t count = 0;
+    if (root) {
+        lv_obj_tree_walk(root, count_cb, &count);
+    }
+    return count;
+}
+
+static void display_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_INVALIDATE_AREA: {
+        const lv_area_t *area = lv_event_get_param(e);
+        s_inv_areas++;
+        if (area) {
+            s_inv_px += lv_area_get_size(area);
+        }
+        break;
+    }
+    case LV_EVENT_RENDER_START:
+        s_render_start_us = esp_timer_get_time();
+        break;
+    case LV_EVENT_RENDER_READY: {
+        if (!s_frame_waiters || !s_render_start_us) {
+            break;
+        }
+        uint32_t us = (uint32_t)(esp_timer_get_time() - s_render_start_us);
+        for (int i = 0; i < UI_PERF_SECTION_COUNT; i++) {
+            if (s_frame_waiters & (1u << i)) {
+                perf_section_t *s = &s_sections[i];
+                s->frames++;
+                s->frame_us_total += us;
+                if (us > s->frame_us_max) {
+                    s->frame_us_max = us;
+                }
+            }
+        }
+        s_frame_waiters = 0;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void log_timer_cb(lv_timer_t *timer)
+{
+    for (int i = 0; i < UI_PERF_SECTION_COUNT; i++) {
+        perf_section_t *s = &s_sections[i];
+        if (s->calls == s->logged_calls) {
+            continue;
+        }
+        s->logged_calls = s->calls;
+        ESP_LOGI(TAG, "%s: %lu 次, 平均 %lu us (最大 %lu), 每次失效 %lu 区 %lu px (最大 %lu px), "
+                 "对象净变化 %ld (增加 %lu 次), 其后一帧渲染平均 %lu us (最大 %lu, %lu 帧)",
+                 s->name, (unsigned long)s->calls,
+                 (unsigned long)(s->us_total / s->calls), (unsigned long)s->us_max,
+                 (unsigned long)(s->inv_areas_total / s->calls), (unsigned long)(s->inv_px_total / s->calls),
+                 (unsigned long)s->inv_px_max, (long)s->objs_delta_total, (unsigned long)s->objs_grew,
+                 (unsigned long)(s->frames ? s->frame_us_total / s->frames : 0),
+                 (unsigned long)s->frame_us_max, (unsigned long)s->frames);
+    }
+}
+
+void ui_perf_init(lv_display_t *disp, lv_obj_t *root)
+{
+    if (!UI_PERF_ENABLED) {
+        return;
+    }
+    s_root = root;
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_READY, NULL);
+    lv_timer_create(log_timer_cb, CONFIG_KDS_UI_PERF_LOG_PERIOD * 1000, NULL);
+}
+
+void ui_perf_begin(ui_perf_section_t section)
+{
+    if (!UI_PERF_ENABLED) {
+        return;
+    }
+    perf_section_t *s = &s_sections[section];
+    // 对象计数在计时之外完成，不计入段内耗时
+    s->start_objs = ui_perf_count_objects(s_root);
+    s->start_inv_areas = s_inv_areas;
+    s->start_inv_px = s_inv_px;
+    s->active = true;
+    s->start_us = esp_timer_get_time();
+}
+
+void ui_perf_end(ui_perf_section_t section)
+{
+    if (!UI_PERF_ENABLED) {
+        return;
+    }
+    perf_section_t *s = &s_sections[section];
+    if (!s->active) {
+        return;
+    }
+    uint32_t us = (uint32_t)(esp_timer_get_time() - s->start_us);
+    s->active = false;
+
+    uint32_t inv_areas = s_inv_areas - s->start_inv_areas;
+    uint32_t inv_px = (uint32_t)(s_inv_px - s->start_inv_px);
+    int32_t objs_delta = (int32_t)(ui_perf_count_objects(s_root) - s->start_objs);
+
+    s->calls++;
+    s->us_total += us;
+    if (us > s->us_max) {
+        s->us_max = us;
+    }
+    s->inv_areas_total += inv_areas;
+    s->inv_px_total += inv_px;
+    if (inv_px > s->inv_px_max) {
+        s->inv_px_max = inv_px;
+    }
+    s->objs_delta_total += objs_delta;
+    if (objs_delta > 0) {
+        s->objs_grew++;
+    }
+    if (inv_areas > 0) {
+        s_frame_waiters |= 1u << section;
+    }
+}
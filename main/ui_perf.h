@@ -0,0 +1,47 @@
+/**
+ * @file ui_perf.h
+ * @brief 界面性能计数：按代码段统计耗时、失效区域、对象数变化与其后一帧的渲染耗时
+ *
+ * 在显示上挂事件回调：LV_EVENT_INVALIDATE_AREA 统计失效区域数与像素数，
+ * LV_EVENT_RENDER_START/READY 统计一帧的渲染耗时。被测代码以 ui_perf_begin/ui_perf_end 包围，
+ * 结束时记录段内耗时、失效区域、界面根对象下的LVGL对象数净变化，段结束后渲染的第一帧计入该段。
+ * 代码段可以嵌套。统计按 CONFIG_KDS_UI_PERF_LOG_PERIOD 周期写入日志，周期为0时整个模块不工作。
+ * 只在持有显示锁时调用（UI任务或LVGL回调）。
+ */
+
+#ifndef UI_PERF_H
+#define UI_PERF_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+typedef enum {
+    UI_PERF_WAITING_LIST,       // 等待列表调和 update_waiting_orders_display()
+    UI_PERF_TICKET_BUMP,        // 网格模式点按小票完成订单，其余小票上移
+    UI_PERF_SECTION_COUNT
+} ui_perf_section_t;
+
+/**
+ * @brief 挂接显示事件并启动周期日志
+ *
+ * @param disp 界面所在的显示
+ * @param root 统计对象数的根对象（订单界面的主容器，不含弹窗）
+ */
+void ui_perf_init(lv_display_t *disp, lv_obj_t *root);
+
+/**
+ * @brief 代码段开始
+ */
+void ui_perf_begin(ui_perf_section_t section);
+
+/**
+ * @brief 代码段结束，累计本次的耗时、失效区域与对象数变化
+ */
+void ui_perf_end(ui_perf_section_t section);
+
+/**
+ * @brief 统计 root 及其全部子孙对象的数量
+ */
+uint32_t ui_perf_count_objects(lv_obj_t *root);
+
+#endif // UI_PERF_H
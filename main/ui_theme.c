@@ -0,0 +1,209 @@
+#include "ui_theme.h"
+#include "font/fonts.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "UITheme";
+
+static lv_style_t s_styles[UI_STYLE_COUNT];
+static bool s_inited = false;
+
+void ui_theme_init(void)
+{
+    if (s_inited) {
+        return;
+    }
+    for (int i = 0; i < UI_STYLE_COUNT; i++) {
+        lv_style_init(&s_styles[i]);
+    }
+
+    lv_style_t *style = &s_styles[UI_STYLE_SCREEN];
+    lv_style_set_pad_all(style, 0);
+    lv_style_set_border_width(style, 0);
+
+    style = &s_styles[UI_STYLE_WAITING_AREA];
+    lv_style_set_pad_all(style, 10);
+    lv_style_set_border_width(style, 0);
+    lv_style_set_bg_color(style, lv_color_white());
+
+    style = &s_styles[UI_STYLE_ORDER_AREA];
+    lv_style_set_border_width(style, 0);
+    lv_style_set_bg_color(style, lv_color_hex(0xF0F2F5));
+
+    style = &s_styles[UI_STYLE_PLAIN];
+    lv_style_set_bg_opa(style, LV_OPA_TRANSP);
+    lv_style_set_border_width(style, 0);
+
+    style = &s_styles[UI_STYLE_WAITING_LIST];
+    lv_style_set_pad_all(style, 0);
+    lv_style_set_bg_opa(style, LV_OPA_TRANSP);
+    lv_style_set_border_width(style, 0);
+
+    style = &s_styles[UI_STYLE_DISH_LIST];
+    lv_style_set_pad_all(style, 10);
+    lv_style_set_pad_gap(style, 10);
+    lv_style_set_border_width(style, 0);
+    lv_style_set_bg_color(style, lv_color_hex(0xFFFFFF));
+
+    style = &s_styles[UI_STYLE_TICKET_GRID];
+    lv_style_set_pad_all(style, 5);
+    lv_style_set_pad_gap(style, 10);
+    lv_style_set_border_width(style, 0);
+    lv_style_set_bg_opa(style, LV_OPA_TRANSP);
+
+    style = &s_styles[UI_STYLE_ORDER_CARD];
+    lv_style_set_bg_color(style, lv_color_hex(0xFFFFFF));
+    lv_style_set_border_color(style, lv_color_hex(0x08C160));
+    lv_style_set_border_width(style, 3);
+
+    style = &s_styles[UI_STYLE_DISH_CHIP];
+    lv_style_set_bg_color(style, lv_color_hex(0xF1F1F1));      // 灰色背景 #F1F1F1
+    lv_style_set_radius(style, 5);                              // 圆角5px
+    lv_style_set_pad_all(style, 8);                             // 内边距8px
+    lv_style_set_border_width(style, 0);                        // 无边框
+    lv_style_set_margin_top(style, 5);                          // 卡片间距
+    lv_style_set_margin_bottom(style, 5);
+    lv_style_set_margin_left(style, 5);
+    lv_style_set_margin_right(style, 5);
+    lv_style_set_text_color(style, lv_color_hex(0x333333));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DISHES, FONT_SIZE_LARGE));
+
+    style = &s_styles[UI_STYLE_DISH_MODS];
+    lv_style_set_text_color(style, lv_color_hex(0xE6A23C));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_PUHUI, FONT_SIZE_MEDIUM));
+
+    // 按钮内的标签继承文字颜色与字体
+    style = &s_styles[UI_STYLE_COMPLETE_BTN];
+    lv_style_set_bg_color(style, lv_color_hex(0x08C160));
+    lv_style_set_radius(style, 8);
+    lv_style_set_text_color(style, lv_color_white());
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DEVICE, FONT_SIZE_LARGE));
+
+    style = &s_styles[UI_STYLE_WAITING_ROW];
+    lv_style_set_bg_color(style, lv_color_hex(0xF8F9FA));
+    lv_style_set_border_width(style, 1);
+    lv_style_set_border_color(style, lv_color_hex(0xDDDDDD));
+    lv_style_set_radius(style, 5);
+
+    style = &s_styles[UI_STYLE_TICKET];
+    lv_style_set_bg_color(style, lv_color_hex(0xFFFFFF));
+    lv_style_set_border_width(style, 1);
+    lv_style_set_border_color(style, lv_color_hex(0xDDDDDD));
+    lv_style_set_radius(style, 8);
+    lv_style_set_pad_all(style, 10);
+
+    // 状态栏文字默认为 montserrat（仅ASCII），需要中文的标签另加 UI_STYLE_STATUS_TEXT_CN
+    style = &s_styles[UI_STYLE_STATUS_BAR];
+    lv_style_set_bg_color(style, lv_color_hex(0xCCCCCC));
+    lv_style_set_border_width(style, 0);
+    lv_style_set_text_font(style, &lv_font_montserrat_14);
+
+    style = &s_styles[UI_STYLE_POPUP];
+    lv_style_set_bg_color(style, lv_color_black());
+    lv_style_set_bg_opa(style, LV_OPA_COVER);
+    lv_style_set_border_width(style, 0);
+    lv_style_set_text_color(style, lv_color_white());
+    lv_style_set_text_font(style, &font_puhui_16_4);
+
+    style = &s_styles[UI_STYLE_SECTION_TITLE];
+    lv_style_set_text_color(style, lv_color_hex(0x333333));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DEVICE, FONT_SIZE_MEDIUM));
+
+    style = &s_styles[UI_STYLE_ORDER_TITLE];
+    lv_style_set_text_color(style, lv_color_hex(0x08C160));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DEVICE, FONT_SIZE_LARGE));
+
+    style = &s_styles[UI_STYLE_DISH_TEXT];
+    lv_style_set_text_color(style, lv_color_hex(0x333333));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DISHES, FONT_SIZE_LARGE));
+
+    style = &s_styles[UI_STYLE_ORDER_HINT];
+    lv_style_set_text_color(style, lv_color_hex(0x999999));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DEVICE, FONT_SIZE_LARGE));
+
+    style = &s_styles[UI_STYLE_WAITING_HINT];
+    lv_style_set_text_color(style, lv_color_hex(0x999999));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DEVICE, FONT_SIZE_MEDIUM));
+
+    style = &s_styles[UI_STYLE_ROW_NUM];
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DEVICE, FONT_SIZE_MEDIUM));
+
+    style = &s_styles[UI_STYLE_ROW_DISHES];
+    lv_style_set_text_color(style, lv_color_hex(0x666666));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_PUHUI, FONT_SIZE_MEDIUM));
+
+    style = &s_styles[UI_STYLE_ROW_STATUS];
+    lv_style_set_text_color(style, lv_color_hex(0x666666));
+    lv_style_set_text_font(style, get_font(FONT_TYPE_DEVICE, FONT_SIZE_SMALL));
+
+    style = &s_styles[UI_STYLE_URGENT];
+    lv_style_set_text_color(style, lv_color_hex(0xF56C6C));
+
+    style = &s_styles[UI_STYLE_STATUS_ITEM];
+    lv_style_set_margin_left(style, 20);
+
+    style = &s_styles[UI_STYLE_STATUS_TEXT_CN];
+    lv_style_set_text_font(style, &font_puhui_16_4);
+
+    style = &s_styles[UI_STYLE_STATUS_TIME];
+    lv_style_set_margin_right(style, 100);
+
+    s_inited = true;
+}
+
+void ui_theme_apply(lv_obj_t *obj, ui_style_t style)
+{
+    if (style < UI_STYLE_COUNT) {
+        lv_obj_add_style(obj, &s_styles[style], LV_PART_MAIN);
+    }
+}
+
+void ui_theme_toggle(lv_obj_t *obj, ui_style_t style, bool on)
+{
+    if (style >= UI_STYLE_COUNT) {
+        return;
+    }
+    // 先移除再附加，避免同一样式叠加多次
+    lv_obj_remove_style(obj, &s_styles[style], LV_PART_MAIN);
+    if (on) {
+        lv_obj_add_style(obj, &s_styles[style], LV_PART_MAIN);
+    }
+}
+
+// 按共享样式或本地样式属性建一张带备注的菜品卡片，返回占用的堆字节数
+static size_t dish_chip_cost(lv_obj_t *parent, bool shared)
+{
+    size_t before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    lv_obj_t *card = lv_obj_create(parent);
+    lv_obj_add_flag(card, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_t *name = lv_label_create(card);
+    lv_label_set_text(name, "宫保鸡丁 x2");
+    lv_obj_t *mods = lv_label_create(card);
+    lv_label_set_text(mods, "少辣");
+    if (shared) {
+        ui_theme_apply(card, UI_STYLE_DISH_CHIP);
+        ui_theme_apply(mods, UI_STYLE_DISH_MODS);
+    } else {
+        // 改用共享样式之前 create_dish_slot() 逐个对象设置的本地属性
+        lv_obj_set_style_bg_color(card, lv_color_hex(0xF1F1F1), 0);
+        lv_obj_set_style_radius(card, 5, 0);
+        lv_obj_set_style_pad_all(card, 8, 0);
+        lv_obj_set_style_border_width(card, 0, 0);
+        lv_obj_set_style_margin_all(card, 5, 0);
+        lv_obj_set_style_text_color(name, lv_color_hex(0x333333), 0);
+        set_font_style(name, FONT_TYPE_DISHES, FONT_SIZE_LARGE);
+        set_font_style(mods, FONT_TYPE_PUHUI, FONT_SIZE_MEDIUM);
+        lv_obj_set_style_text_color(mods, lv_color_hex(0xE6A23C), 0);
+    }
+    size_t after = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    lv_obj_del(card);
+    return before > after ? before - after : 0;
+}
+
+void ui_theme_log_cost(lv_obj_t *parent)
+{
+    size_t shared = dish_chip_cost(parent, true);
+    size_t local = dish_chip_cost(parent, false);
+    ESP_LOGI(TAG, "菜品卡片堆占用: 共享样式 %u 字节, 本地样式属性 %u 字节",
+             (unsigned)shared, (unsigned)local);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file ui_theme.h
+ * @brief 界面共享样式：常用控件的外观集中为少量静态 lv_style_t
+ *
+ * 样式在 ui_theme_init 中建立一次，各控件通过 lv_obj_add_style 引用同一份样式，
+ * 不再为每个对象单独分配本地样式属性。只在持有显示锁时调用。
+ */
+
+#ifndef UI_THEME_H
+#define UI_THEME_H
+
+#include "lvgl.h"
+
+typedef enum {
+    // 容器
+    UI_STYLE_SCREEN,            // 主容器：无边框无内边距
+    UI_STYLE_WAITING_AREA,      // 等待订单区域：白底
+    UI_STYLE_ORDER_AREA,        // 当前订单区域：浅灰底
+    UI_STYLE_PLAIN,             // 透明无边框的布局容器
+    UI_STYLE_WAITING_LIST,      // 等待订单滚动列表：透明、无边框无内边距
+    UI_STYLE_DISH_LIST,         // 订单卡片中的菜品区域
+    UI_STYLE_TICKET_GRID,       // 网格模式的小票网格
+    // 控件
+    UI_STYLE_ORDER_CARD,        // 当前订单卡片：白底绿框
+    UI_STYLE_DISH_CHIP,         // 菜品卡片：灰底圆角，菜名字体
+    UI_STYLE_DISH_MODS,         // 菜品备注文字
+    UI_STYLE_COMPLETE_BTN,      // 出餐按钮：绿底白字
+    UI_STYLE_WAITING_ROW,       // 等待订单行
+    UI_STYLE_TICKET,            // 网格模式的订单小票
+    UI_STYLE_STATUS_BAR,        // 底部状态栏
+    UI_STYLE_POPUP,             // 提示弹窗：黑底白字
+    // 文字
+    UI_STYLE_SECTION_TITLE,     // 区域标题
+    UI_STYLE_ORDER_TITLE,       // 订单号标题（订单卡片与小票）：绿色大字
+    UI_STYLE_DISH_TEXT,         // 小票中的菜品文字
+    UI_STYLE_ORDER_HINT,        // 当前订单区域的空闲提示
+    UI_STYLE_WAITING_HINT,      // 等待列表的空闲提示
+    UI_STYLE_ROW_NUM,           // 等待行：订单号
+    UI_STYLE_ROW_DISHES,        // 等待行：菜品摘要
+    UI_STYLE_ROW_STATUS,        // 等待行：状态
+    UI_STYLE_URGENT,            // 加急订单的状态文字，叠加在 UI_STYLE_ROW_STATUS 之上
+    UI_STYLE_STATUS_ITEM,       // 状态栏左侧各项的间距
+    UI_STYLE_STATUS_TEXT_CN,    // 状态栏中需要中文字体的文字
+    UI_STYLE_STATUS_TIME,       // 状态栏右侧时间
+    UI_STYLE_COUNT
+} ui_style_t;
+
+/**
+ * @brief 建立共享样式，需在创建界面控件之前调用
+ */
+void ui_theme_init(void);
+
+/**
+ * @brief 为对象的主体部分附加共享样式
+ * @param obj LVGL对象
+ * @param style 样式类型
+ */
+void ui_theme_apply(lv_obj_t *obj, ui_style_t style);
+
+/**
+ * @brief 附加或移除一个共享样式（用于加急等随状态切换的外观），重复调用结果相同
+ * @param obj LVGL对象
+ * @param style 样式类型
+ * @param on true 附加（排在已有样式之后，优先生效），false 移除
+ */
+void ui_theme_toggle(lv_obj_t *obj, ui_style_t style, bool on);
+
+/**
+ * @brief 实测一张菜品卡片在共享样式与本地样式属性下的堆占用并写入日志
+ *
+ * 在 parent 下临时创建两张隐藏的菜品卡片，分别比较创建前后的空闲堆，测完即删除。
+ * @param parent 临时卡片的父对象
+ */
+void ui_theme_log_cost(lv_obj_t *parent);
+
+#endif // UI_THEME_H
@@ -4,60 +4,132 @@
  */
 
 #include "utf8_validator.h"
-#include "esp_log.h"
+#include <string.h>
 
-static const char *TAG = "UTF8_VALIDATOR";
-
-/**
- * @brief 验证字符串是否为有效的UTF-8编码
- * 
- * UTF-8编码规则：
- * - 单字节字符: 0xxxxxxx (ASCII范围: 0x00-0x7F)
- * - 双字节字符: 110xxxxx 10xxxxxx (范围: 0xC0-0xDF 0x80-0xBF)
- * - 三字节字符: 1110xxxx 10xxxxxx 10xxxxxx (范围: 0xE0-0xEF 0x80-0xBF 0x80-0xBF)
- * - 四字节字符: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx (范围: 0xF0-0xF7 0x80-0xBF 0x80-0xBF 0x80-0xBF)
- * 
- * @param data 要验证的数据
- * @param length 数据长度
- * @return true 如果是有效的UTF-8编码
- * @return false 如果不是有效的UTF-8编码
+/*
+ * 基于状态机的严格UTF-8验证。
+ *
+ * 每个字节先映射到字符类，再由 (状态, 字符类) 查表得到下一状态：
+ * - 0x00-0x7F 单字节
+ * - 0xC2-0xDF 双字节首字节（0xC0/0xC1 只能构成超长编码，无效）
+ * - 0xE0 之后必须为 0xA0-0xBF（排除超长编码）
+ * - 0xED 之后必须为 0x80-0x9F（排除代理区 U+D800-U+DFFF）
+ * - 0xF0 之后必须为 0x90-0xBF（排除超长编码）
+ * - 0xF4 之后必须为 0x80-0x8F（不超过 U+10FFFF）
+ * - 0xF5-0xFF 无效
+ * 状态机处于起始状态时，以8字节为单位跳过纯ASCII数据，并整体跳过首字节无特殊
+ * 取值限制的完整三字节字符（常用汉字）。
  */
-bool utf8_is_valid(const uint8_t *data, size_t length) {
-    bool is_valid_utf8 = true;
-    
-    for (size_t i = 0; i < length; i++) {
-        uint8_t c = data[i];
-        if (c > 0x7F) { // 非ASCII字符
-            // 检查UTF-8编码有效性
-            if ((c & 0xE0) == 0xC0) { // 2字节UTF-8
-                if (i + 1 >= length || (data[i+1] & 0xC0) != 0x80) {
-                    is_valid_utf8 = false;
-                    break;
-                }
-                i++; // 跳过下一个字节
-            } else if ((c & 0xF0) == 0xE0) { // 3字节UTF-8
-                if (i + 2 >= length || 
-                    (data[i+1] & 0xC0) != 0x80 ||
-                    (data[i+2] & 0xC0) != 0x80) {
-                    is_valid_utf8 = false;
-                    break;
-                }
-                i += 2; // 跳过两个字节
-            } else if ((c & 0xF8) == 0xF0) { // 4字节UTF-8
-                if (i + 3 >= length || 
-                    (data[i+1] & 0xC0) != 0x80 ||
-                    (data[i+2] & 0xC0) != 0x80 ||
-                    (data[i+3] & 0xC0) != 0x80) {
-                    is_valid_utf8 = false;
+
+enum {
+    S_ACCEPT = 0,   /* 字符边界 */
+    S_REJECT,
+    S_TAIL1,        /* 还需1个续字节 */
+    S_TAIL2,        /* 还需2个续字节 */
+    S_E0,           /* 0xE0 后：A0-BF，再1个续字节 */
+    S_ED,           /* 0xED 后：80-9F，再1个续字节 */
+    S_TAIL3,        /* 还需3个续字节 */
+    S_F0,           /* 0xF0 后：90-BF，再2个续字节 */
+    S_F4,           /* 0xF4 后：80-8F，再2个续字节 */
+    S_COUNT
+};
+
+/* 字符类：0 ASCII，1 续字节80-8F，2 续字节90-9F，3 续字节A0-BF，
+ * 4 C2-DF，5 E0，6 E1-EC/EE-EF，7 ED，8 F0，9 F1-F3，10 F4，11 无效 */
+static const uint8_t s_byte_class[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    11, 11, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7, 6, 6, 8, 9, 9, 9, 10, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+};
+
+#define R S_REJECT
+static const uint8_t s_transition[S_COUNT][12] = {
+    /* 列依次为字符类 0-11 */
+    [S_ACCEPT] = { S_ACCEPT, R, R, R, S_TAIL1, S_E0, S_TAIL2, S_ED, S_F0, S_TAIL3, S_F4, R },
+    [S_REJECT] = { R, R, R, R, R, R, R, R, R, R, R, R },
+    [S_TAIL1]  = { R, S_ACCEPT, S_ACCEPT, S_ACCEPT, R, R, R, R, R, R, R, R },
+    [S_TAIL2]  = { R, S_TAIL1, S_TAIL1, S_TAIL1, R, R, R, R, R, R, R, R },
+    [S_E0]     = { R, R, R, S_TAIL1, R, R, R, R, R, R, R, R },
+    [S_ED]     = { R, S_TAIL1, S_TAIL1, R, R, R, R, R, R, R, R, R },
+    [S_TAIL3]  = { R, S_TAIL2, S_TAIL2, S_TAIL2, R, R, R, R, R, R, R, R },
+    [S_F0]     = { R, R, S_TAIL2, S_TAIL2, R, R, R, R, R, R, R, R },
+    [S_F4]     = { R, S_TAIL2, R, R, R, R, R, R, R, R, R, R },
+};
+#undef R
+
+#define ASCII_BLOCK_MASK 0x8080808080808080ULL
+
+bool utf8_validate_count(const uint8_t *data, size_t length, size_t *codepoints) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+    size_t count = 0;
+    uint8_t state = S_ACCEPT;
+
+    while (p < end) {
+        if (state == S_ACCEPT) {
+            /* 字符边界处成段跳过：纯ASCII以8字节为单位；首字节为 E1-EC/EE-EF 的完整三字节
+             * 字符（常用汉字）无特殊取值限制，只需确认两个续字节。其余情况交给状态机 */
+            while (p < end) {
+                if (*p < 0x80) {
+                    uint64_t block;
+                    if (end - p < 8) {
+                        break;
+                    }
+                    memcpy(&block, p, sizeof(block));
+                    if (block & ASCII_BLOCK_MASK) {
+                        break;
+                    }
+                    p += 8;
+                    count += 8;
+                } else if (end - p >= 3 && s_byte_class[p[0]] == 6 &&
+                           (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80) {
+                    p += 3;
+                    count++;
+                } else {
                     break;
                 }
-                i += 3; // 跳过三个字节
-            } else {
-                is_valid_utf8 = false;
+            }
+            if (p == end) {
                 break;
             }
         }
+
+        state = s_transition[state][s_byte_class[*p++]];
+        if (state == S_ACCEPT) {
+            count++;
+        } else if (state == S_REJECT) {
+            return false;
+        }
+    }
+
+    if (state != S_ACCEPT) {
+        return false; /* 末尾多字节序列不完整 */
+    }
+    if (codepoints) {
+        *codepoints = count;
+    }
+    return true;
+}
+
+bool utf8_is_valid(const uint8_t *data, size_t length) {
+    return utf8_validate_count(data, length, NULL);
+}
+
+size_t utf8_trim_len(const uint8_t *data, size_t length) {
+    size_t start = length;
+
+    /* 向前找最后一个非续字节，按其首字节判断序列是否完整 */
+    for (int k = 0; k < 4 && start > 0; k++) {
+        uint8_t c = data[--start];
+        if ((c & 0xC0) != 0x80) {
+            size_t need = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            return length - start >= need ? length : start;
+        }
     }
-    
-    return is_valid_utf8;
-}
\ No newline at end of file
+    return length; /* 末尾全是续字节，不是截断造成的，不处理 */
+}
@@ -13,6 +13,8 @@
 /**
  * @brief 验证字符串是否为有效的UTF-8编码
  * 
+ * 严格模式：超长编码、代理区码点(U+D800-U+DFFF)与超出U+10FFFF的码点均视为无效。
+ * 
  * @param data 要验证的数据
  * @param length 数据长度
  * @return true 如果是有效的UTF-8编码
@@ -20,4 +22,28 @@
  */
 bool utf8_is_valid(const uint8_t *data, size_t length);
 
-#endif /* UTF8_VALIDATOR_H */
\ No newline at end of file
+/**
+ * @brief 验证UTF-8编码并统计码点数
+ * 
+ * 与 utf8_is_valid() 规则相同，一次扫描同时得到码点数，供UI估算标签宽度。
+ * 
+ * @param data 要验证的数据
+ * @param length 数据长度
+ * @param codepoints 输出码点数，可为NULL；无效时不修改
+ * @return true 如果是有效的UTF-8编码
+ */
+bool utf8_validate_count(const uint8_t *data, size_t length, size_t *codepoints);
+
+/**
+ * @brief 截断后的文本去掉末尾不完整的多字节字符
+ * 
+ * 只检查最后至多4个字节：若末尾的多字节序列缺少续字节，返回该序列首字节之前的长度。
+ * 用于把有效的UTF-8文本按字节截断进固定缓冲区后，保证不显示半个字符。
+ * 
+ * @param data 文本
+ * @param length 截断后的长度
+ * @return 以完整字符结尾的长度
+ */
+size_t utf8_trim_len(const uint8_t *data, size_t length);
+
+#endif /* UTF8_VALIDATOR_H */